@@ -0,0 +1,131 @@
+//AllocCheck.h
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Heap allocation check behind --alloc-check (configure with GLOOM_ALLOC_CHECK=ON).
+// Replaces the global operator new and delete, so include it from exactly one
+// translation unit. While a thread is armed, every allocation it makes is
+// counted and the first few print a backtrace to stderr. Other threads (asset
+// workers, audio) are never counted.
+#ifdef GLOOM_ALLOC_CHECK
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#include <unistd.h>
+#define GLOOM_ALLOC_BACKTRACE
+#endif
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace allocCheck {
+    const size_t maxReports = 8;
+
+    inline thread_local bool armed = false;
+    inline thread_local bool reporting = false;  // Don't count what the report itself allocates
+    inline thread_local size_t count = 0;
+
+    inline void record(size_t size) {
+        if (!armed || reporting) return;
+        reporting = true;
+        if (++count <= maxReports) {
+            std::fprintf(stderr, "allocation of %zu bytes in a checked tick:\n", size);
+#ifdef GLOOM_ALLOC_BACKTRACE
+            void* frames[32];
+            int depth = backtrace(frames, 32);
+            backtrace_symbols_fd(frames, depth, STDERR_FILENO);  // Writes directly, no malloc
+#endif
+        }
+        reporting = false;
+    }
+
+    inline void arm() {
+#ifdef GLOOM_ALLOC_BACKTRACE
+        void* frame;
+        backtrace(&frame, 1);  // The first call loads the unwinder; do that now
+#endif
+        count = 0;
+        armed = true;
+    }
+
+    // Returns how many allocations were made since arm()
+    inline size_t disarm() {
+        armed = false;
+        return count;
+    }
+
+    // MSVC has no std::aligned_alloc, and its aligned blocks need their own free
+    inline void* alignedAllocate(size_t size, size_t alignment) {
+#ifdef _WIN32
+        return _aligned_malloc(size ? size : 1, alignment);
+#else
+        return std::aligned_alloc(alignment, ((size ? size : 1) + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+    inline void alignedFree(void* memory) {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+}
+
+void* operator new(std::size_t size) {
+    allocCheck::record(size);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    allocCheck::record(size);
+    if (void* memory = allocCheck::alignedAllocate(size, static_cast<size_t>(alignment))) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    allocCheck::alignedFree(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+    allocCheck::alignedFree(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+    allocCheck::alignedFree(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {
+    allocCheck::alignedFree(memory);
+}
+
+#endif
@@ -0,0 +1,57 @@
+//Animation.h
+#pragma once
+#include <vector>
+#include "Atlas.h"
+
+// A run of atlas frames played at a fixed rate. Clips come straight from the
+// sprite-sheet metadata AtlasPacker generates; a single sprite is a 1-frame clip.
+struct AnimationClip {
+    atlas::Sheet sheet;
+    float frameTime;  // Seconds per frame, 0 for a still image
+};
+
+// Plays any number of clip instances. Instance state lives in parallel arrays so
+// advancing every animation is one tight loop rather than a call per entity.
+class Animator {
+public:
+    size_t add(const AnimationClip& clip, int startFrame = 0) {
+        firstFrames.push_back(clip.sheet.first);
+        frameCounts.push_back(clip.sheet.count);
+        frameTimes.push_back(clip.frameTime);
+        times.push_back(0.0f);
+        frames.push_back(startFrame % clip.sheet.count);
+        return frames.size() - 1;
+    }
+
+    // Switches an instance to another clip, starting from its first frame
+    void play(size_t id, const AnimationClip& clip) {
+        firstFrames[id] = clip.sheet.first;
+        frameCounts[id] = clip.sheet.count;
+        frameTimes[id] = clip.frameTime;
+        times[id] = 0.0f;
+        frames[id] = 0;
+    }
+
+    void advance(float deltaTime) {
+        for (size_t i = 0; i < frames.size(); i++) {
+            if (frameTimes[i] <= 0.0f) continue;
+            times[i] += deltaTime;
+            while (times[i] >= frameTimes[i]) {
+                times[i] -= frameTimes[i];
+                frames[i] = (frames[i] + 1) % frameCounts[i];
+            }
+        }
+    }
+
+    atlas::Sprite sprite(size_t id) const {
+        return static_cast<atlas::Sprite>(firstFrames[id] + frames[id]);
+    }
+
+    size_t size() const {
+        return frames.size();
+    }
+
+private:
+    std::vector<int> firstFrames, frameCounts, frames;
+    std::vector<float> frameTimes, times;
+};
@@ -0,0 +1,159 @@
+//Arena.h
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Linear allocator: allocating bumps an offset, freeing single allocations does
+// nothing, and reset() (or rewind() to a mark) releases everything after a
+// point at once. Memory comes in blocks that are kept across resets, so once an
+// arena has grown to its high-water mark, a loop that resets it every frame
+// never touches the heap again. Destructors are not run; objects in an arena
+// must be destroyed (or trivially destructible) before it is reset.
+// Not thread-safe: one arena per thread.
+class Arena {
+public:
+    struct Marker {
+        size_t block;
+        size_t offset;
+    };
+
+    explicit Arena(size_t blockSize = 64 * 1024)
+    : blockSize(blockSize), current(0), offset(0), earlierBlocks(0), peak(0) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // alignment must be a power of two
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        for (;;) {
+            if (current == blocks.size()) {
+                blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[std::max(blockSize, size + alignment)]),
+                                  std::max(blockSize, size + alignment)});
+            }
+            Block& block = blocks[current];
+            std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.memory.get());
+            size_t start = static_cast<size_t>(((base + offset + alignment - 1) & ~(std::uintptr_t(alignment) - 1)) - base);
+            if (start + size <= block.size) {
+                offset = start + size;
+                peak = std::max(peak, bytesUsed());
+                return block.memory.get() + start;
+            }
+            // Move on to the next block, kept from an earlier frame or made above
+            earlierBlocks += block.size;
+            current++;
+            offset = 0;
+        }
+    }
+
+    Marker mark() const {
+        return {current, offset};
+    }
+
+    // Frees everything allocated since marker was taken
+    void rewind(Marker marker) {
+        current = marker.block;
+        offset = marker.offset;
+        earlierBlocks = 0;
+        for (size_t i = 0; i < current; i++) {
+            earlierBlocks += blocks[i].size;
+        }
+    }
+
+    void reset() {
+        rewind({0, 0});
+    }
+
+    // Bytes handed out (plus block tails skipped over) since the last reset
+    size_t bytesUsed() const {
+        return earlierBlocks + offset;
+    }
+
+    size_t peakBytes() const {
+        return peak;
+    }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (const auto& block : blocks) {
+            total += block.size;
+        }
+        return total;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> memory;
+        size_t size;
+    };
+
+    size_t blockSize;
+    std::vector<Block> blocks;
+    size_t current, offset;  // Next free byte
+    size_t earlierBlocks;    // Sizes of the blocks before current
+    size_t peak;
+};
+
+// STL allocator over an Arena. deallocate() is a no-op: memory comes back when
+// the arena is reset, so containers using it must not outlive that reset.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator(Arena& arena) noexcept : arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t count) {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(T)) throw std::bad_array_new_length();
+        return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena == other.arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return arena != other.arena;
+    }
+
+    Arena* arena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// This thread's scratch arena, for temporaries that die before the function
+// that made them returns. Take it through a ScratchScope so nested users unwind.
+inline Arena& scratchArena() {
+    thread_local Arena arena;
+    return arena;
+}
+
+// Rewinds the thread's scratch arena on scope exit. Declare it before the
+// containers that use it so they are destroyed first.
+class ScratchScope {
+public:
+    ScratchScope() : arena(scratchArena()), marker(arena.mark()) {}
+
+    ~ScratchScope() {
+        arena.rewind(marker);
+    }
+
+    ScratchScope(const ScratchScope&) = delete;
+
+    Arena& arena;
+
+private:
+    Arena::Marker marker;
+};
@@ -0,0 +1,155 @@
+//AssetArchive.h
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// On-disk layout of assets.pak, written by AtlasPacker --archive. A header and
+// table of contents up front, then 16-byte aligned blobs. Images are normally
+// stored as decoded RGBA8 so a texture is created by uploading straight from the
+// file; an archive built with --keep-png holds them as Raw PNG bytes instead.
+namespace pak {
+
+const char magic[8] = {'G', 'L', 'O', 'O', 'M', 'P', 'A', 'K'};
+const std::uint32_t version = 1;
+const std::uint64_t alignment = 16;
+
+enum EntryType : std::uint32_t {
+    Raw = 0,   // File bytes as-is (fonts, audio, manifests, kept PNGs)
+    Rgba = 1   // width * height * 4 bytes of decoded pixels
+};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t entryCount;
+};
+
+struct Entry {
+    char name[64];
+    std::uint32_t type;
+    std::uint32_t width, height;
+    std::uint32_t reserved;
+    std::uint64_t offset, size;  // From the start of the file
+};
+
+}
+
+// Read-only view of an assets.pak. The file is memory-mapped, so looking up an
+// entry costs nothing and its bytes are paged in only when first touched.
+class AssetArchive {
+public:
+    AssetArchive() : base(nullptr), length(0), borrowed(false) {}
+
+    ~AssetArchive() {
+        close();
+    }
+
+    AssetArchive(const AssetArchive&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        base = reinterpret_cast<const unsigned char*>(buffer.data());
+        length = buffer.size();
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // The mapping keeps the file alive
+        if (mapped == MAP_FAILED) return false;
+        base = static_cast<const unsigned char*>(mapped);
+        length = static_cast<size_t>(info.st_size);
+#endif
+        if (!buildIndex()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // An archive already in memory (e.g. compiled into the executable). The
+    // bytes are not copied and must outlive the archive; 16-byte alignment keeps
+    // entries aligned as they are in a mapped file.
+    bool openMemory(const void* bytes, size_t size) {
+        close();
+        base = static_cast<const unsigned char*>(bytes);
+        length = size;
+        borrowed = true;
+        if (!buildIndex()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        buffer.clear();
+#else
+        if (base && !borrowed) munmap(const_cast<unsigned char*>(base), length);
+#endif
+        borrowed = false;
+        base = nullptr;
+        length = 0;
+        index.clear();
+    }
+
+    bool isOpen() const {
+        return base != nullptr;
+    }
+
+    const pak::Entry* find(const std::string& name) const {
+        auto found = index.find(name);
+        return found == index.end() ? nullptr : found->second;
+    }
+
+    const void* data(const pak::Entry& entry) const {
+        return base + entry.offset;
+    }
+
+private:
+    const unsigned char* base;
+    size_t length;
+    bool borrowed;  // From openMemory(), not ours to unmap
+    std::unordered_map<std::string, const pak::Entry*> index;
+#ifdef _WIN32
+    std::vector<char> buffer;
+#endif
+
+    bool buildIndex() {
+        if (length < sizeof(pak::Header)) return false;
+        const pak::Header* header = reinterpret_cast<const pak::Header*>(base);
+        if (std::memcmp(header->magic, pak::magic, sizeof(pak::magic)) != 0 || header->version != pak::version) {
+            return false;
+        }
+        if (sizeof(pak::Header) + std::uint64_t(header->entryCount) * sizeof(pak::Entry) > length) return false;
+
+        const pak::Entry* entries = reinterpret_cast<const pak::Entry*>(base + sizeof(pak::Header));
+        for (std::uint32_t i = 0; i < header->entryCount; i++) {
+            const pak::Entry& entry = entries[i];
+            if (entry.offset > length || entry.size > length - entry.offset) return false;
+            if (entry.type == pak::Rgba && std::uint64_t(entry.width) * entry.height * 4 != entry.size) return false;
+            index[std::string(entry.name, strnlen(entry.name, sizeof(entry.name)))] = &entry;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,530 @@
+//AssetManager.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Arena.h"
+#include "AssetArchive.h"
+#include "Log.h"
+#include "MemoryTracker.h"
+
+// Cheap copyable references to assets owned by an AssetManager
+struct TextureHandle {
+    unsigned int id = ~0u;
+    bool valid() const { return id != ~0u; }
+};
+
+struct FontHandle {
+    unsigned int id = ~0u;
+    bool valid() const { return id != ~0u; }
+};
+
+// Raw file bytes, e.g. music that sf::Music streams from memory
+struct DataHandle {
+    unsigned int id = ~0u;
+    bool valid() const { return id != ~0u; }
+};
+
+#ifdef GLOOM_EMBEDDED_ASSETS
+// The asset archive compiled into the executable (AtlasPacker --embed)
+extern const unsigned char embeddedAssets[];
+extern const std::size_t embeddedAssetsSize;
+#endif
+
+enum class LoadPriority {
+    Critical,  // Needed before the first game frame
+    Deferred   // Streamed in while the game runs
+};
+
+// Loads textures, fonts and raw files relative to one asset root. Requesting the
+// same path twice returns the same handle. startLoading() hands every new request
+// to a pool of worker threads that decode in the background, critical requests
+// first; poll() then finishes whatever has been decoded (texture uploads, font
+// setup) on the calling thread, so GL work stays on one thread. Until a texture
+// is loaded texture() returns a transparent placeholder, so draws never wait.
+//
+// With a texture budget set (see TextureBudget), trimTextures() unloads the
+// least recently drawn deferred textures while it is over. An evicted texture
+// is the placeholder again and reloads by itself the next time it is drawn.
+//
+// If the root holds an assets.pak, anything it contains is served from the
+// mapped archive instead: textures upload straight from pre-decoded pixels and
+// fonts read from the mapping, so neither touches a decoder or a loose file.
+// Built with GLOOM_EMBEDDED_ASSETS the archive is compiled into the executable
+// instead and nothing is read from disk at all; anything missing from it fails.
+//
+// Requests must all come from one thread, before any other thread reads handles.
+class AssetManager {
+public:
+    AssetManager(const std::string& rootDirectory)
+    : rootDirectory(rootDirectory), frame(1), stopping(false) {
+        if (!this->rootDirectory.empty() && this->rootDirectory.back() != '/' && this->rootDirectory.back() != '\\') {
+            this->rootDirectory += '/';
+        }
+#ifdef GLOOM_EMBEDDED_ASSETS
+        pack.openMemory(embeddedAssets, embeddedAssetsSize);
+        archiveName = "embedded assets";
+        looseFiles = false;
+#else
+        pack.open(resolve("assets.pak"));
+        archiveName = "assets.pak";
+        looseFiles = true;
+#endif
+
+        const sf::Uint8 clear[4] = {0, 0, 0, 0};
+        placeholder.create(1, 1);
+        placeholder.update(clear);
+    }
+
+    AssetManager(const AssetManager&) = delete;
+
+    ~AssetManager() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        jobsReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Asset root from --assets <dir>, else $GLOOM_ASSET_ROOT, else the executable's directory
+    static std::string findRoot(int argc, char* argv[]) {
+        for (int i = 1; i + 1 < argc; i++) {
+            if (std::string(argv[i]) == "--assets") return argv[i + 1];
+        }
+        if (const char* env = std::getenv("GLOOM_ASSET_ROOT")) return env;
+        std::string exe = argc > 0 ? argv[0] : "";
+        size_t slash = exe.find_last_of("/\\");
+        return slash == std::string::npos ? "./" : exe.substr(0, slash + 1);
+    }
+
+    const std::string& root() const {
+        return rootDirectory;
+    }
+
+    std::string resolve(const std::string& relativePath) const {
+        return rootDirectory + relativePath;
+    }
+
+    const AssetArchive& archive() const {
+        return pack;
+    }
+
+    // Whole file as bytes, from the archive if it has it (and fromArchive is set).
+    // Blocks; for small files.
+    bool readFile(const std::string& relativePath, std::string& out, bool fromArchive = true) const {
+        if (const pak::Entry* entry = fromArchive ? pack.find(relativePath) : nullptr) {
+            if (entry->type != pak::Raw) return false;
+            out.assign(static_cast<const char*>(pack.data(*entry)), entry->size);
+            return true;
+        }
+        if (!looseFiles) return false;
+        std::ifstream file(resolve(relativePath), std::ios::binary);
+        if (!file) return false;
+        out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    TextureHandle requestTexture(const std::string& relativePath, LoadPriority priority = LoadPriority::Critical) {
+        TextureHandle handle;
+        handle.id = request(Entry::Texture, relativePath, priority);
+        return handle;
+    }
+
+    FontHandle requestFont(const std::string& relativePath, LoadPriority priority = LoadPriority::Critical) {
+        FontHandle handle;
+        handle.id = request(Entry::Font, relativePath, priority);
+        return handle;
+    }
+
+    DataHandle requestData(const std::string& relativePath, LoadPriority priority = LoadPriority::Critical) {
+        DataHandle handle;
+        handle.id = request(Entry::Data, relativePath, priority);
+        return handle;
+    }
+
+    // Queues everything requested since the last call. Archived assets need no
+    // decode (bar PNGs kept compressed) and are ready for the next poll() straight away.
+    void startLoading() {
+        if (workers.empty()) {
+            unsigned int workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+            for (unsigned int i = 0; i < std::max(1u, workerCount); i++) {
+                workers.emplace_back([this] { work(); });
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& entry : entries) {
+            if (entry->state != Requested) continue;
+            entry->packed = entry->looseOnly ? nullptr : pack.find(entry->path);
+            bool needsDecode = entry->kind == Entry::Texture && entry->packed && entry->packed->type == pak::Raw;
+            if ((entry->packed && !needsDecode) || (!entry->packed && !looseFiles)) {
+                entry->decoded = entry->packed != nullptr;
+                entry->state = Decoded;
+                finished.push_back(entry.get());
+            } else {
+                entry->state = Queued;
+                (entry->priority == LoadPriority::Critical ? criticalJobs : deferredJobs).push_back(entry.get());
+            }
+        }
+        jobsReady.notify_all();
+    }
+
+    // Finishes up to maxAssets decoded assets, critical ones first, and reports
+    // each failure. Call once a frame on a thread that can make GL calls; a small
+    // limit keeps texture uploads from stalling a frame. Returns how many finished.
+    size_t poll(size_t maxAssets = SIZE_MAX) {
+        requestEvicted();
+        ScratchScope scratch;
+        ArenaVector<Entry*> ready(scratch.arena);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::stable_partition(finished.begin(), finished.end(), [](const Entry* entry) {
+                return entry->priority == LoadPriority::Critical;
+            });
+            size_t count = std::min(maxAssets, finished.size());
+            ready.assign(finished.begin(), finished.begin() + count);
+            finished.erase(finished.begin(), finished.begin() + count);
+        }
+        for (Entry* entry : ready) {
+            finish(*entry);
+        }
+        return ready.size();
+    }
+
+    // Blocks until everything requested so far is loaded. Returns false if anything failed.
+    bool loadAll() {
+        startLoading();
+        while (pending(LoadPriority::Critical) + pending(LoadPriority::Deferred) > 0) {
+            if (poll() > 0) continue;
+            std::unique_lock<std::mutex> lock(mutex);
+            assetsDecoded.wait(lock, [&] { return !finished.empty(); });
+        }
+        return std::none_of(entries.begin(), entries.end(), [](const std::unique_ptr<Entry>& entry) {
+            return entry->state == Failed;
+        });
+    }
+
+    // Hot reload: re-reads every loaded asset that came from relativePath, from
+    // the loose file (the archive is a snapshot of the last build) and swaps it
+    // in place, so handles and references to it stay valid. Blocks on the decode,
+    // and nothing may draw with the asset meanwhile. Sizes may change. Returns
+    // true if anything was replaced; on failure the old asset is kept.
+    bool reload(const std::string& relativePath) {
+        bool replaced = false;
+        for (auto& entry : entries) {
+            if (entry->path == relativePath && entry->state == Evicted) {
+                entry->looseOnly = true;  // Nothing to swap; it comes back from the loose file
+                replaced = true;
+            }
+            if (entry->path != relativePath || entry->state != Loaded) continue;
+            if (reloadEntry(*entry)) {
+                replaced = true;
+            } else {
+                std::cerr << "Failed to reload " << resolve(relativePath) << ", keeping the old one" << std::endl;
+            }
+        }
+        return replaced;
+    }
+
+    // Assets of this priority still on their way (failed and evicted ones count as done)
+    size_t pending(LoadPriority priority) const {
+        size_t count = 0;
+        for (const auto& entry : entries) {
+            LoadState state = entry->state;
+            if (entry->priority == priority && state != Loaded && state != Failed && state != Evicted) count++;
+        }
+        return count;
+    }
+
+    // Starts a frame for lastUsed. Call on the render thread before drawing, so
+    // ages count frames drawn rather than poll() calls, which can run faster.
+    void beginFrame() {
+        frame.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Bytes of texture memory shared by these textures and the map's tiles; 0 for no limit
+    void setTextureBudget(size_t bytes) {
+        textureBudget().setLimit(bytes);
+    }
+
+    // Evicts deferred textures, least recently drawn first, until everything
+    // charged to the texture budget fits. Critical textures stay, since no game
+    // frame can be drawn without them, and so does anything drawn this frame or
+    // the last, so the budget can be overshot when that much is on screen. Call
+    // on the GL thread, where nothing is drawing; returns the bytes freed.
+    size_t trimTextures() {
+        size_t excess = textureBudget().excess();
+        if (excess == 0) return 0;
+
+        ScratchScope scratch;
+        ArenaVector<Entry*> candidates(scratch.arena);
+        std::uint64_t now = frame.load(std::memory_order_relaxed);
+        for (auto& entry : entries) {
+            if (entry->kind != Entry::Texture || entry->priority != LoadPriority::Deferred || entry->state != Loaded) continue;
+            if (entry->lastUsed.load(std::memory_order_relaxed) + 1 >= now) continue;
+            candidates.push_back(entry.get());
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b) {
+            return a->lastUsed.load(std::memory_order_relaxed) < b->lastUsed.load(std::memory_order_relaxed);
+        });
+
+        size_t freed = 0;
+        for (Entry* entry : candidates) {
+            if (freed >= excess) break;
+            size_t bytes = entry->pixels.get();
+            entry->wanted.store(false, std::memory_order_relaxed);
+            entry->state.store(Evicted, std::memory_order_release);
+            entry->texture = sf::Texture();
+            entry->charge();
+            freed += bytes;
+            LOG_DEBUG("Evicted texture %s (%zu KiB)", entry->path.c_str(), bytes / 1024);
+        }
+        return freed;
+    }
+
+    // Fraction of critical assets done, for the loading screen
+    float progress() const {
+        size_t total = 0;
+        for (const auto& entry : entries) {
+            if (entry->priority == LoadPriority::Critical) total++;
+        }
+        return total == 0 ? 1.0f : 1.0f - static_cast<float>(pending(LoadPriority::Critical)) / total;
+    }
+
+    // True once a critical asset failed to load
+    bool criticalFailed() const {
+        return std::any_of(entries.begin(), entries.end(), [](const std::unique_ptr<Entry>& entry) {
+            return entry->priority == LoadPriority::Critical && entry->state == Failed;
+        });
+    }
+
+    // Status only: checking a texture doesn't count as drawing it, nor bring it back
+    bool isLoaded(TextureHandle handle) const { return loaded(handle.id); }
+    bool isLoaded(FontHandle handle) const { return loaded(handle.id); }
+    bool isLoaded(DataHandle handle) const { return loaded(handle.id); }
+
+    // Creates a texture straight from archived RGBA pixels, no decode or copy
+    static bool uploadPacked(sf::Texture& texture, const pak::Entry& entry, const AssetArchive& archive) {
+        if (entry.type != pak::Rgba || !texture.create(entry.width, entry.height)) return false;
+        texture.update(static_cast<const sf::Uint8*>(archive.data(entry)));
+        return true;
+    }
+
+    // The placeholder until the texture is loaded, or while it is evicted. Call
+    // it only to draw with the result: it marks the texture as used this frame
+    // and asks for an evicted one back.
+    const sf::Texture& texture(TextureHandle handle) const {
+        return touch(handle.id) ? entries[handle.id]->texture : placeholder;
+    }
+
+    // Has no glyphs until isLoaded(handle)
+    const sf::Font& font(FontHandle handle) const {
+        return entries[handle.id]->font;
+    }
+
+    // Only valid once isLoaded(handle)
+    const void* data(DataHandle handle) const {
+        return bytes(*entries[handle.id]);
+    }
+
+    size_t dataSize(DataHandle handle) const {
+        return byteCount(*entries[handle.id]);
+    }
+
+private:
+    enum LoadState {
+        Requested,  // Not handed to startLoading() yet
+        Queued,     // Waiting for a worker
+        Decoded,    // Waiting for poll()
+        Loaded,
+        Failed,
+        Evicted     // Texture dropped by trimTextures(); reloads once wanted again
+    };
+
+    struct Entry {
+        enum Kind { Texture, Font, Data } kind;
+        std::string path;
+        LoadPriority priority;
+        std::atomic<LoadState> state{Requested};
+        const pak::Entry* packed = nullptr;
+        bool looseOnly = false;   // Hot reloaded; the archive's copy is stale
+        bool decoded = false;
+        std::atomic<std::uint64_t> lastUsed{0};  // Frame of the last texture() call
+        std::atomic<bool> wanted{false};         // Used while evicted
+        sf::Texture texture;
+        sf::Image image;          // Decoded pixels awaiting upload
+        sf::Font font;
+        std::vector<char> data;   // File bytes; sf::Font and sf::Music read from them lazily
+        MemoryCharge pixels{AssetMemory, true};  // Counts toward the texture budget
+        MemoryCharge memory{AssetMemory};
+
+        // Texture pixels and any file bytes held in RAM; archived bytes are mapped, not charged
+        void charge() {
+            pixels.set(kind == Texture ? MemoryCharge::textureBytes(texture.getSize()) : 0);
+            memory.set(data.capacity());
+        }
+    };
+
+    std::string rootDirectory;
+    AssetArchive pack;
+    std::string archiveName;
+    bool looseFiles;  // False when everything must come from the archive
+    sf::Texture placeholder;
+    std::vector<std::unique_ptr<Entry>> entries;  // Stable addresses for handles and workers
+    std::unordered_map<std::string, unsigned int> ids[3];  // Per Entry::Kind
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable jobsReady, assetsDecoded;
+    std::deque<Entry*> criticalJobs, deferredJobs;
+    std::vector<Entry*> finished;
+    std::atomic<std::uint64_t> frame;  // Counts beginFrame() calls, for lastUsed
+    bool stopping;
+
+    unsigned int request(Entry::Kind kind, const std::string& relativePath, LoadPriority priority) {
+        auto found = ids[kind].find(relativePath);
+        if (found != ids[kind].end()) {
+            // A later critical request promotes a deferred one that hasn't been queued yet
+            Entry& entry = *entries[found->second];
+            if (priority == LoadPriority::Critical && entry.state == Requested) entry.priority = priority;
+            return found->second;
+        }
+        unsigned int id = static_cast<unsigned int>(entries.size());
+        ids[kind][relativePath] = id;
+        entries.emplace_back(new Entry);
+        entries.back()->kind = kind;
+        entries.back()->path = relativePath;
+        entries.back()->priority = priority;
+        return id;
+    }
+
+    bool loaded(unsigned int id) const {
+        return entries[id]->state.load(std::memory_order_acquire) == Loaded;
+    }
+
+    // loaded(), recording that the texture is drawn; asks for it back if it was evicted
+    bool touch(unsigned int id) const {
+        Entry& entry = *entries[id];
+        entry.lastUsed.store(frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        LoadState state = entry.state.load(std::memory_order_acquire);
+        if (state == Evicted) entry.wanted.store(true, std::memory_order_relaxed);
+        return state == Loaded;
+    }
+
+    // Queues evicted textures drawn since the last poll()
+    void requestEvicted() {
+        bool any = false;
+        for (auto& entry : entries) {
+            if (entry->state == Evicted && entry->wanted.exchange(false, std::memory_order_relaxed)) {
+                entry->state = Requested;
+                any = true;
+            }
+        }
+        if (any) startLoading();
+    }
+
+    const void* bytes(const Entry& entry) const {
+        return entry.packed ? pack.data(*entry.packed) : entry.data.data();
+    }
+
+    size_t byteCount(const Entry& entry) const {
+        return entry.packed ? static_cast<size_t>(entry.packed->size) : entry.data.size();
+    }
+
+    bool reloadEntry(Entry& entry) {
+        if (entry.kind == Entry::Texture) {
+            sf::Image image;
+            if (!image.loadFromFile(resolve(entry.path))) return false;
+            if (image.getSize() == entry.texture.getSize()) {
+                entry.texture.update(image);
+            } else if (!entry.texture.loadFromImage(image)) {
+                return false;
+            }
+            entry.packed = nullptr;
+            entry.looseOnly = true;
+            entry.charge();
+            return true;
+        }
+
+        std::ifstream file(resolve(entry.path), std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (data.empty()) return false;
+        if (entry.kind == Entry::Font) {
+            sf::Font check;
+            if (!check.loadFromMemory(data.data(), data.size())) return false;
+        }
+        // Anything reading the old bytes (the font, a playing sf::Music) must be done with them
+        entry.data.swap(data);
+        entry.packed = nullptr;
+        entry.charge();
+        return entry.kind != Entry::Font || entry.font.loadFromMemory(entry.data.data(), entry.data.size());
+    }
+
+    void work() {
+        for (;;) {
+            Entry* entry;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobsReady.wait(lock, [&] { return stopping || !criticalJobs.empty() || !deferredJobs.empty(); });
+                if (stopping) return;
+                std::deque<Entry*>& jobs = criticalJobs.empty() ? deferredJobs : criticalJobs;
+                entry = jobs.front();
+                jobs.pop_front();
+            }
+
+            if (entry->kind == Entry::Texture && entry->packed) {
+                entry->decoded = entry->image.loadFromMemory(pack.data(*entry->packed), entry->packed->size);
+            } else if (entry->kind == Entry::Texture) {
+                entry->decoded = entry->image.loadFromFile(resolve(entry->path));
+            } else {
+                std::ifstream file(resolve(entry->path), std::ios::binary);
+                entry->data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                entry->decoded = !entry->data.empty();
+            }
+            entry->state = Decoded;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.push_back(entry);
+            }
+            assetsDecoded.notify_all();
+        }
+    }
+
+    void finish(Entry& entry) {
+        bool ok = entry.decoded;
+        if (ok && entry.packed && entry.packed->type == pak::Rgba && entry.kind != Entry::Texture) ok = false;
+        if (ok && entry.kind == Entry::Texture) {
+            bool pixels = entry.packed && entry.packed->type == pak::Rgba;
+            ok = pixels ? uploadPacked(entry.texture, *entry.packed, pack) : entry.texture.loadFromImage(entry.image);
+            entry.image = sf::Image();  // Pixels live on the GPU now
+        } else if (ok && entry.kind == Entry::Font) {
+            ok = entry.font.loadFromMemory(bytes(entry), byteCount(entry));
+        }
+        entry.charge();
+        entry.lastUsed.store(frame.load(std::memory_order_relaxed), std::memory_order_relaxed);  // Not cold yet
+        entry.state.store(ok ? Loaded : Failed, std::memory_order_release);
+
+        if (!ok) {
+            static const char* const kinds[] = {"texture", "font", "file"};
+            std::cerr << "Failed to load " << kinds[entry.kind] << " "
+                      << (entry.packed || !looseFiles ? entry.path + " from " + archiveName : resolve(entry.path)) << std::endl;
+        }
+    }
+};
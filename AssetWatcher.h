@@ -0,0 +1,86 @@
+//AssetWatcher.h
+#pragma once
+#include <SFML/System.hpp>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Watches the asset directory for files that were rewritten (inotify on Linux,
+// a no-op elsewhere). Changes are held back until the directory has been quiet
+// for a moment, so a tool writing several files at once is seen as one batch.
+class AssetWatcher {
+public:
+    AssetWatcher() : fd(-1) {}
+
+    ~AssetWatcher() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    AssetWatcher(const AssetWatcher&) = delete;
+
+    bool watch(const std::string& directory) {
+#ifdef __linux__
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) return false;
+        // Editors and build tools either rewrite in place or rename a new file over the old
+        if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        return true;
+#else
+        (void)directory;
+        std::cerr << "Asset hot reload needs inotify (Linux only)" << std::endl;
+        return false;
+#endif
+    }
+
+    // File names (relative to the watched directory) changed since the last
+    // batch, or nothing while writes are still coming in. Cheap enough to call every frame.
+    std::vector<std::string> changes() {
+        std::vector<std::string> batch;
+#ifdef __linux__
+        if (fd < 0) return batch;
+
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char* at = buffer; at < buffer + length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(at);
+                std::string name = event->len ? event->name : "";
+                if (!name.empty() && !isTemporary(name) &&
+                    std::find(pending.begin(), pending.end(), name) == pending.end()) {
+                    pending.push_back(name);
+                }
+                at += sizeof(inotify_event) + event->len;
+            }
+            sinceLastEvent.restart();
+        }
+
+        if (!pending.empty() && sinceLastEvent.getElapsedTime() >= settleTime) {
+            batch.swap(pending);
+        }
+#endif
+        return batch;
+    }
+
+private:
+    const sf::Time settleTime = sf::milliseconds(200);
+
+    int fd;
+    std::vector<std::string> pending;
+    sf::Clock sinceLastEvent;
+
+    // Files written aside before being renamed into place
+    static bool isTemporary(const std::string& name) {
+        return name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0;
+    }
+};
@@ -0,0 +1,64 @@
+//Atlas.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include "AssetManager.h"
+#include "AtlasData.h"
+
+// Texture pages produced by AtlasPacker at build time, addressed by atlas::Sprite.
+// Everything on one page can be drawn in a single batch. Core pages are needed
+// for the first frame; pages of other groups (ambient critters) load later.
+class Atlas {
+public:
+    Atlas(AssetManager& assets) : assets(assets) {
+        for (int i = 0; i < atlas::pageCount; i++) {
+            bool core = std::strcmp(atlas::pageGroups[i], "core") == 0;
+            pages[i] = assets.requestTexture(atlas::pageFiles[i], core ? LoadPriority::Critical : LoadPriority::Deferred);
+        }
+    }
+
+    // For drawing only; see AssetManager::texture()
+    const sf::Texture& texture(atlas::Sprite sprite) const {
+        return assets.texture(pages[atlas::regions[sprite].page]);
+    }
+
+    // False while the sprite's page is still loading or evicted. No side effects.
+    bool isReady(atlas::Sprite sprite) const {
+        return assets.isLoaded(pages[atlas::regions[sprite].page]);
+    }
+
+    // Hot reload: takes the layout from the packer's .regions file after the
+    // atlas was repacked. Only sprites the game was built with can move; new
+    // ones need a rebuild. Returns false if the file couldn't be read.
+    bool reloadRegions(const std::string& regionsFile) {
+        std::string text;
+        if (!assets.readFile(regionsFile, text, false)) return false;
+        std::istringstream lines(text);
+        std::string name;
+        atlas::Region region;
+        while (lines >> name >> region.page >> region.left >> region.top >> region.width >> region.height) {
+            for (int i = 0; i < atlas::SpriteCount; i++) {
+                if (name == atlas::spriteNames[i] && region.page >= 0 && region.page < atlas::pageCount) {
+                    atlas::regions[i] = region;
+                }
+            }
+        }
+        return true;
+    }
+
+    static sf::IntRect rect(atlas::Sprite sprite) {
+        const atlas::Region& region = atlas::regions[sprite];
+        return sf::IntRect(region.left, region.top, region.width, region.height);
+    }
+
+    // Frame of a sprite sheet, wrapping around past the last one
+    static atlas::Sprite frame(const atlas::Sheet& sheet, int index) {
+        return static_cast<atlas::Sprite>(sheet.first + index % sheet.count);
+    }
+
+private:
+    const AssetManager& assets;
+    TextureHandle pages[atlas::pageCount];
+};
@@ -0,0 +1,466 @@
+//AtlasPacker.cpp
+// Build-time tool: packs sprite PNGs (and the frames of sprite sheets) into one
+// or a few atlas pages and writes a header naming the sub-rect of every sprite.
+//
+// Usage: AtlasPacker <page prefix> <header out> [--group <name>] Name=file.png[@WxH[xN]]...
+//   @WxH   splits the file into a grid of WxH frames, named Name_0, Name_1, ...
+//   xN     keeps only the first N frames of the grid (row-major)
+//   --group starts a new group; each group gets its own pages so the game can
+//           load them separately. Sprites before the first --group are "core".
+//   Also writes <page prefix>.regions, the same table as text, which a running
+//   game reloads when the atlas is repacked.
+//
+// Usage: AtlasPacker --chunks <map.png> <chunk size> <out prefix>
+//   Slices a background map into <prefix>_<x>_<y>.png tiles plus a
+//   <prefix>.chunks manifest that the game streams in around the camera.
+//
+// Usage: AtlasPacker --archive [--keep-png] <out.pak> <file>...
+//   Packs files into one archive (see AssetArchive.h). PNGs are stored decoded
+//   as RGBA (or as-is with --keep-png, for a smaller archive), a .chunks
+//   manifest pulls in all of its tiles, anything else is raw.
+//
+// Usage: AtlasPacker --embed <in.pak> <out.cpp>
+//   Writes the archive as a byte array (embeddedAssets, embeddedAssetsSize)
+//   to compile into the game.
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "AssetArchive.h"
+
+const unsigned int pageSize = 2048;
+const unsigned int padding = 1;  // Empty texels between sprites so neighbours never bleed
+
+struct Frame {
+    std::string name;
+    std::string group;
+    size_t image;
+    sf::IntRect area;  // Area inside the source image
+    int page;
+    unsigned int x, y;  // Position on the page
+};
+
+struct Sheet {
+    std::string name;
+    size_t first, count;
+};
+
+bool parseEntry(const std::string& arg, const std::string& group, std::vector<sf::Image>& images,
+                std::vector<Frame>& frames, std::vector<Sheet>& sheets) {
+    size_t equals = arg.find('=');
+    if (equals == std::string::npos || equals == 0) {
+        std::cerr << "Bad entry '" << arg << "', expected Name=file.png[@WxH[xN]]" << std::endl;
+        return false;
+    }
+    std::string name = arg.substr(0, equals);
+    std::string file = arg.substr(equals + 1);
+    unsigned int frameWidth = 0, frameHeight = 0, frameLimit = 0;
+
+    size_t at = file.rfind('@');
+    if (at != std::string::npos) {
+        std::string grid = file.substr(at + 1);
+        file = file.substr(0, at);
+        if (std::sscanf(grid.c_str(), "%ux%ux%u", &frameWidth, &frameHeight, &frameLimit) < 2 ||
+            frameWidth == 0 || frameHeight == 0) {
+            std::cerr << "Bad frame grid '" << grid << "' for " << name << std::endl;
+            return false;
+        }
+    }
+
+    images.emplace_back();
+    if (!images.back().loadFromFile(file)) {
+        std::cerr << "Failed to load " << file << std::endl;
+        return false;
+    }
+    sf::Vector2u size = images.back().getSize();
+    size_t image = images.size() - 1;
+
+    if (frameWidth == 0) {
+        frames.push_back({name, group, image, sf::IntRect(0, 0, size.x, size.y), 0, 0, 0});
+        return true;
+    }
+
+    Sheet sheet{name, frames.size(), 0};
+    for (unsigned int top = 0; top + frameHeight <= size.y; top += frameHeight) {
+        for (unsigned int left = 0; left + frameWidth <= size.x; left += frameWidth) {
+            if (frameLimit && sheet.count == frameLimit) break;
+            frames.push_back({name + "_" + std::to_string(sheet.count), group, image,
+                              sf::IntRect(left, top, frameWidth, frameHeight), 0, 0, 0});
+            sheet.count++;
+        }
+    }
+    if (sheet.count == 0) {
+        std::cerr << file << " is smaller than one " << frameWidth << "x" << frameHeight << " frame" << std::endl;
+        return false;
+    }
+    sheets.push_back(sheet);
+    return true;
+}
+
+// Shelf packing, tallest first. Each group starts on a fresh page, and a new page
+// opens whenever the current one is full. pageGroups names the group of each page.
+int pack(std::vector<Frame>& frames, std::vector<sf::Vector2u>& pageSizes, std::vector<std::string>& pageGroups) {
+    std::vector<Frame*> order;
+    std::vector<std::string> groups;
+    for (auto& frame : frames) {
+        if (frame.area.width + padding > pageSize || frame.area.height + padding > pageSize) {
+            std::cerr << frame.name << " does not fit on a " << pageSize << "x" << pageSize << " page" << std::endl;
+            return -1;
+        }
+        if (std::find(groups.begin(), groups.end(), frame.group) == groups.end()) groups.push_back(frame.group);
+        order.push_back(&frame);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](const Frame* a, const Frame* b) {
+        size_t groupA = std::find(groups.begin(), groups.end(), a->group) - groups.begin();
+        size_t groupB = std::find(groups.begin(), groups.end(), b->group) - groups.begin();
+        if (groupA != groupB) return groupA < groupB;
+        return a->area.height > b->area.height;
+    });
+
+    int page = 0;
+    unsigned int x = padding, y = padding, shelfHeight = 0;
+    pageSizes.assign(1, sf::Vector2u(0, 0));
+    pageGroups.assign(1, order.empty() ? "core" : order.front()->group);
+    for (Frame* frame : order) {
+        if (frame->group != pageGroups[page]) {
+            page++;
+            pageSizes.emplace_back(0, 0);
+            pageGroups.push_back(frame->group);
+            x = padding;
+            y = padding;
+            shelfHeight = 0;
+        }
+        unsigned int width = frame->area.width, height = frame->area.height;
+        if (x + width + padding > pageSize) {
+            x = padding;
+            y += shelfHeight + padding;
+            shelfHeight = 0;
+        }
+        if (y + height + padding > pageSize) {
+            page++;
+            pageSizes.emplace_back(0, 0);
+            pageGroups.push_back(frame->group);
+            x = padding;
+            y = padding;
+            shelfHeight = 0;
+        }
+        frame->page = page;
+        frame->x = x;
+        frame->y = y;
+        x += width + padding;
+        shelfHeight = std::max(shelfHeight, height);
+        pageSizes[page].x = std::max(pageSizes[page].x, x);
+        pageSizes[page].y = std::max(pageSizes[page].y, y + height + padding);
+    }
+    return page + 1;
+}
+
+std::string baseName(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool writeHeader(const std::string& path, const std::vector<std::string>& pageFiles, const std::vector<std::string>& pageGroups,
+                 const std::vector<Frame>& frames, const std::vector<Sheet>& sheets) {
+    std::ofstream out(path);
+    out << "// Generated by AtlasPacker from the sprite list in CMakeLists.txt - do not edit.\n"
+        << "#pragma once\n\n"
+        << "namespace atlas {\n\n"
+        << "struct Region {\n    int page;\n    int left, top, width, height;\n};\n\n"
+        << "struct Sheet {\n    int first, count;\n};\n\n"
+        << "const int pageCount = " << pageFiles.size() << ";\n"
+        << "const char* const pageFiles[pageCount] = {";
+    for (size_t i = 0; i < pageFiles.size(); i++) {
+        out << (i ? ", " : "") << "\"" << pageFiles[i] << "\"";
+    }
+    out << "};\n"
+        << "const char* const pageGroups[pageCount] = {";
+    for (size_t i = 0; i < pageGroups.size(); i++) {
+        out << (i ? ", " : "") << "\"" << pageGroups[i] << "\"";
+    }
+    out << "};\n\nenum Sprite {\n";
+    for (const auto& frame : frames) {
+        out << "    " << frame.name << ",\n";
+    }
+    out << "    SpriteCount\n};\n\n"
+        << "const char* const spriteNames[SpriteCount] = {\n";
+    for (const auto& frame : frames) {
+        out << "    \"" << frame.name << "\",\n";
+    }
+    out << "};\n\n"
+        << "// Not const: hot reload swaps in the table from the .regions file\n"
+        << "inline Region regions[SpriteCount] = {\n";
+    for (const auto& frame : frames) {
+        out << "    {" << frame.page << ", " << frame.x << ", " << frame.y << ", "
+            << frame.area.width << ", " << frame.area.height << "},  // " << frame.name << "\n";
+    }
+    out << "};\n\n";
+    for (const auto& sheet : sheets) {
+        out << "const Sheet " << sheet.name << "Sheet = {" << sheet.name << "_0, " << sheet.count << "};\n";
+    }
+    out << "\n}\n";
+    return static_cast<bool>(out);
+}
+
+// One line per sprite: name page left top width height
+bool writeRegions(const std::string& path, const std::vector<Frame>& frames) {
+    std::ofstream out(path);
+    for (const auto& frame : frames) {
+        out << frame.name << " " << frame.page << " " << frame.x << " " << frame.y << " "
+            << frame.area.width << " " << frame.area.height << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+// Manifest line: chunk size, columns, rows, world width, world height, tile prefix
+bool sliceMap(const std::string& mapFile, unsigned int chunkSize, const std::string& prefix) {
+    sf::Image map;
+    if (!map.loadFromFile(mapFile)) {
+        std::cerr << "Failed to load " << mapFile << std::endl;
+        return false;
+    }
+    sf::Vector2u size = map.getSize();
+    unsigned int columns = (size.x + chunkSize - 1) / chunkSize;
+    unsigned int rows = (size.y + chunkSize - 1) / chunkSize;
+
+    for (unsigned int y = 0; y < rows; y++) {
+        for (unsigned int x = 0; x < columns; x++) {
+            sf::IntRect area(x * chunkSize, y * chunkSize,
+                             std::min(chunkSize, size.x - x * chunkSize), std::min(chunkSize, size.y - y * chunkSize));
+            sf::Image chunk;
+            chunk.create(area.width, area.height);
+            chunk.copy(map, 0, 0, area);
+            std::string file = prefix + "_" + std::to_string(x) + "_" + std::to_string(y) + ".png";
+            if (!chunk.saveToFile(file)) {
+                std::cerr << "Failed to write " << file << std::endl;
+                return false;
+            }
+        }
+    }
+
+    std::ofstream manifest(prefix + ".chunks");
+    manifest << chunkSize << " " << columns << " " << rows << " " << size.x << " " << size.y << " " << baseName(prefix) << "\n";
+    return static_cast<bool>(manifest);
+}
+
+struct ArchiveFile {
+    std::string name;
+    pak::EntryType type;
+    unsigned int width, height;
+    std::vector<char> data;
+};
+
+bool addToArchive(const std::string& path, bool keepPng, std::vector<ArchiveFile>& files) {
+    ArchiveFile file{baseName(path), pak::Raw, 0, 0, {}};
+    if (file.name.size() >= sizeof(pak::Entry::name)) {
+        std::cerr << "Archive name too long: " << file.name << std::endl;
+        return false;
+    }
+
+    if (!keepPng && path.size() > 4 && path.compare(path.size() - 4, 4, ".png") == 0) {
+        sf::Image image;
+        if (!image.loadFromFile(path)) {
+            std::cerr << "Failed to load " << path << std::endl;
+            return false;
+        }
+        file.type = pak::Rgba;
+        file.width = image.getSize().x;
+        file.height = image.getSize().y;
+        const char* pixels = reinterpret_cast<const char*>(image.getPixelsPtr());
+        file.data.assign(pixels, pixels + file.width * file.height * 4);
+    } else {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::cerr << "Failed to read " << path << std::endl;
+            return false;
+        }
+        file.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    files.push_back(file);
+
+    // A chunk manifest brings its tiles along
+    if (path.size() > 7 && path.compare(path.size() - 7, 7, ".chunks") == 0) {
+        std::string directory = path.substr(0, path.size() - baseName(path).size());
+        std::ifstream manifest(path);
+        int chunkSize, columns, rows, width, height;
+        std::string prefix;
+        if (!(manifest >> chunkSize >> columns >> rows >> width >> height >> prefix)) {
+            std::cerr << "Bad chunk manifest " << path << std::endl;
+            return false;
+        }
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < columns; x++) {
+                std::string tile = directory + prefix + "_" + std::to_string(x) + "_" + std::to_string(y) + ".png";
+                if (!addToArchive(tile, keepPng, files)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool writeArchive(const std::string& path, const std::vector<ArchiveFile>& files) {
+    pak::Header header;
+    std::memcpy(header.magic, pak::magic, sizeof(header.magic));
+    header.version = pak::version;
+    header.entryCount = static_cast<std::uint32_t>(files.size());
+
+    std::vector<pak::Entry> entries(files.size());
+    std::uint64_t offset = sizeof(pak::Header) + files.size() * sizeof(pak::Entry);
+    for (size_t i = 0; i < files.size(); i++) {
+        offset = (offset + pak::alignment - 1) / pak::alignment * pak::alignment;
+        pak::Entry& entry = entries[i];
+        std::memset(&entry, 0, sizeof(entry));
+        std::memcpy(entry.name, files[i].name.c_str(), files[i].name.size());
+        entry.type = files[i].type;
+        entry.width = files[i].width;
+        entry.height = files[i].height;
+        entry.offset = offset;
+        entry.size = files[i].data.size();
+        offset += entry.size;
+    }
+
+    // Written aside and renamed over the old one: a running game has the old
+    // archive mapped, and truncating it in place would pull pages out from under it
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(pak::Entry));
+        for (size_t i = 0; i < files.size(); i++) {
+            std::vector<char> gap(entries[i].offset - static_cast<std::uint64_t>(out.tellp()), 0);
+            out.write(gap.data(), gap.size());
+            out.write(files[i].data.data(), files[i].data.size());
+        }
+        if (!out) return false;
+    }
+    // rename() swaps the new file in atomically, so a reader never finds it
+    // missing; on Windows it won't replace an existing file at all
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+// Plain byte initialisers: string literals would compile faster but MSVC caps their length
+bool writeEmbedded(const std::string& archivePath, const std::string& sourcePath) {
+    std::ifstream in(archivePath, std::ios::binary);
+    if (!in) {
+        std::cerr << "Failed to read " << archivePath << std::endl;
+        return false;
+    }
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    std::ofstream out(sourcePath);
+    out << "// Generated by AtlasPacker --embed from " << baseName(archivePath) << " - do not edit.\n"
+        << "#include <cstddef>\n\n"
+        << "// Aligned like a mapped file, so archive entries keep their alignment\n"
+        << "alignas(16) extern const unsigned char embeddedAssets[] = {";
+    for (size_t i = 0; i < bytes.size(); i++) {
+        out << (i % 24 ? "," : i ? ",\n    " : "\n    ") << static_cast<unsigned int>(static_cast<unsigned char>(bytes[i]));
+    }
+    out << "\n};\n"
+        << "extern const std::size_t embeddedAssetsSize = " << bytes.size() << ";\n";
+    if (!out) {
+        std::cerr << "Failed to write " << sourcePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 3 && std::string(argv[1]) == "--archive") {
+        bool keepPng = std::string(argv[2]) == "--keep-png";
+        int first = keepPng ? 3 : 2;
+        if (first >= argc) {
+            std::cerr << "Usage: AtlasPacker --archive [--keep-png] <out.pak> <file>..." << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::vector<ArchiveFile> files;
+        for (int i = first + 1; i < argc; i++) {
+            if (!addToArchive(argv[i], keepPng, files)) return EXIT_FAILURE;
+        }
+        if (!writeArchive(argv[first], files)) {
+            std::cerr << "Failed to write " << argv[first] << std::endl;
+            return EXIT_FAILURE;
+        }
+        return 0;
+    }
+    if (argc == 4 && std::string(argv[1]) == "--embed") {
+        if (!writeEmbedded(argv[2], argv[3])) return EXIT_FAILURE;
+        return 0;
+    }
+    if (argc == 5 && std::string(argv[1]) == "--chunks") {
+        int chunkSize = std::atoi(argv[3]);
+        if (chunkSize <= 0) {
+            std::cerr << "Bad chunk size " << argv[3] << std::endl;
+            return EXIT_FAILURE;
+        }
+        return sliceMap(argv[2], chunkSize, argv[4]) ? 0 : EXIT_FAILURE;
+    }
+    if (argc < 4) {
+        std::cerr << "Usage: AtlasPacker <page prefix> <header out> [--group <name>] Name=file.png[@WxH[xN]]..." << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string pagePrefix = argv[1];
+    std::string headerPath = argv[2];
+
+    std::vector<sf::Image> images;
+    std::vector<Frame> frames;
+    std::vector<Sheet> sheets;
+
+    // A solid white region lets untextured shapes (health bars) share the atlas draw call
+    images.emplace_back();
+    images.back().create(4, 4, sf::Color::White);
+    frames.push_back({"White", "core", 0, sf::IntRect(0, 0, 4, 4), 0, 0, 0});
+
+    std::string group = "core";
+    for (int i = 3; i < argc; i++) {
+        if (std::string(argv[i]) == "--group") {
+            if (++i == argc) {
+                std::cerr << "--group needs a name" << std::endl;
+                return EXIT_FAILURE;
+            }
+            group = argv[i];
+            continue;
+        }
+        if (!parseEntry(argv[i], group, images, frames, sheets)) return EXIT_FAILURE;
+    }
+
+    std::vector<sf::Vector2u> pageSizes;
+    std::vector<std::string> pageGroups;
+    int pageCount = pack(frames, pageSizes, pageGroups);
+    if (pageCount < 0) return EXIT_FAILURE;
+
+    std::vector<sf::Image> pages(pageCount);
+    std::vector<std::string> pageFiles;
+    for (int i = 0; i < pageCount; i++) {
+        pages[i].create(pageSizes[i].x, pageSizes[i].y, sf::Color::Transparent);
+    }
+    for (const auto& frame : frames) {
+        pages[frame.page].copy(images[frame.image], frame.x, frame.y, frame.area);
+    }
+    for (int i = 0; i < pageCount; i++) {
+        std::string file = pagePrefix + std::to_string(i) + ".png";
+        if (!pages[i].saveToFile(file)) {
+            std::cerr << "Failed to write " << file << std::endl;
+            return EXIT_FAILURE;
+        }
+        pageFiles.push_back(baseName(file));
+    }
+
+    if (!writeHeader(headerPath, pageFiles, pageGroups, frames, sheets)) {
+        std::cerr << "Failed to write " << headerPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!writeRegions(pagePrefix + ".regions", frames)) {
+        std::cerr << "Failed to write " << pagePrefix << ".regions" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
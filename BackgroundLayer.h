@@ -0,0 +1,95 @@
+//BackgroundLayer.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "MemoryTracker.h"
+#include "SpatialGrid.h"
+
+// Composites layers that never change (map, scenery) into an offscreen texture
+// once, then blits that as a single quad. The bake covers the view plus a
+// margin on every side, so panning within the margin just shows another part
+// of it; the bake is only redone when the layer set is invalidated, the view
+// leaves the baked area, or the zoom or target size changes.
+class BackgroundLayer : public sf::Drawable {
+public:
+    static const unsigned int margin = 256;  // Target pixels baked past each edge of the view
+
+    BackgroundLayer() : dirty(true), quad(sf::Quads, 4), cacheMemory(RenderMemory) {}
+
+    void addLayer(const sf::Drawable& layer) {
+        layers.push_back(&layer);
+        invalidate();
+    }
+
+    void clearLayers() {
+        layers.clear();
+        invalidate();
+    }
+
+    // Call when a layer's contents change, e.g. on level load
+    void invalidate() {
+        dirty = true;
+    }
+
+    // Returns true if the cache was re-baked this call
+    bool update(const sf::View& view, sf::Vector2u targetSize) {
+        sf::FloatRect visible = visibleArea(view);
+        sf::Vector2f pixel(view.getSize().x / targetSize.x, view.getSize().y / targetSize.y);  // World units per target pixel
+        if (!dirty && targetSize == bakedTarget && pixel == bakedPixel && contains(baked, visible)) {
+            return false;
+        }
+
+        unsigned int limit = sf::Texture::getMaximumSize();
+        sf::Vector2u cacheSize(std::min(limit, static_cast<unsigned int>(std::ceil(visible.width / pixel.x)) + 2 * margin),
+                               std::min(limit, static_cast<unsigned int>(std::ceil(visible.height / pixel.y)) + 2 * margin));
+        if (cacheSize != cache.getSize()) {
+            if (!cache.create(cacheSize.x, cacheSize.y)) return false;
+            cacheMemory.set(MemoryCharge::textureBytes(cacheSize));
+        }
+
+        sf::Vector2f size(cacheSize.x * pixel.x, cacheSize.y * pixel.y);
+        sf::Vector2f center(visible.left + visible.width / 2, visible.top + visible.height / 2);
+        baked = sf::FloatRect(center - size / 2.0f, size);
+        cache.setView(sf::View(baked));
+        cache.clear();
+        for (const sf::Drawable* layer : layers) {
+            cache.draw(*layer);
+        }
+        cache.display();
+
+        // The quad sits in world space over the whole baked area; the target's view crops it
+        sf::Vector2f topLeft(baked.left, baked.top);
+        sf::Vector2f texSize(static_cast<float>(cacheSize.x), static_cast<float>(cacheSize.y));
+        quad[0] = sf::Vertex(topLeft, sf::Vector2f(0, 0));
+        quad[1] = sf::Vertex(sf::Vector2f(topLeft.x + size.x, topLeft.y), sf::Vector2f(texSize.x, 0));
+        quad[2] = sf::Vertex(topLeft + size, texSize);
+        quad[3] = sf::Vertex(sf::Vector2f(topLeft.x, topLeft.y + size.y), sf::Vector2f(0, texSize.y));
+
+        bakedTarget = targetSize;
+        bakedPixel = pixel;
+        dirty = false;
+        return true;
+    }
+
+private:
+    std::vector<const sf::Drawable*> layers;
+    sf::RenderTexture cache;
+    bool dirty;
+    sf::FloatRect baked;     // World area in the cache
+    sf::Vector2u bakedTarget;
+    sf::Vector2f bakedPixel;
+    sf::VertexArray quad;
+    MemoryCharge cacheMemory;
+
+    static bool contains(const sf::FloatRect& outer, const sf::FloatRect& inner) {
+        return inner.left >= outer.left && inner.top >= outer.top &&
+               inner.left + inner.width <= outer.left + outer.width && inner.top + inner.height <= outer.top + outer.height;
+    }
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
+        states.texture = &cache.getTexture();
+        target.draw(quad, states);
+    }
+};
@@ -0,0 +1,71 @@
+//Camera.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+
+// Pans and zooms a view over a world of fixed size, never showing past its edges
+class Camera {
+public:
+    Camera(sf::Vector2f viewSize, sf::Vector2f worldSize)
+    : baseSize(viewSize), world(worldSize), zoomLevel(1.0f) {
+        current.setSize(viewSize);
+        current.setCenter(viewSize / 2.0f);
+        clamp();
+    }
+
+    void setWorldSize(sf::Vector2f worldSize) {
+        world = worldSize;
+        clamp();
+    }
+
+    void pan(sf::Vector2f delta) {
+        current.move(delta);
+        clamp();
+    }
+
+    // Zooms by factor (<1 zooms in) keeping worldPoint under the cursor
+    void zoomAt(float factor, sf::Vector2f worldPoint) {
+        float maxZoom = std::max(1.0f, std::min(world.x / baseSize.x, world.y / baseSize.y));
+        float newZoom = std::max(minZoom, std::min(maxZoom, zoomLevel * factor));
+        float applied = newZoom / zoomLevel;
+        zoomLevel = newZoom;
+
+        current.setSize(baseSize * zoomLevel);
+        current.setCenter(worldPoint + (current.getCenter() - worldPoint) * applied);
+        clamp();
+    }
+
+    // Keyboard panning: arrow keys or WASD. The keyboard state is global, so
+    // pass false while the window is in the background to ignore it.
+    void update(float deltaTime, bool focused) {
+        if (!focused) return;
+        sf::Vector2f direction;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left) || sf::Keyboard::isKeyPressed(sf::Keyboard::A)) direction.x -= 1;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right) || sf::Keyboard::isKeyPressed(sf::Keyboard::D)) direction.x += 1;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up) || sf::Keyboard::isKeyPressed(sf::Keyboard::W)) direction.y -= 1;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down) || sf::Keyboard::isKeyPressed(sf::Keyboard::S)) direction.y += 1;
+        if (direction.x != 0 || direction.y != 0) {
+            pan(direction * panSpeed * zoomLevel * deltaTime);
+        }
+    }
+
+    const sf::View& view() const {
+        return current;
+    }
+
+private:
+    static constexpr float minZoom = 0.5f;
+    static constexpr float panSpeed = 800.0f;  // Screen pixels per second
+
+    sf::Vector2f baseSize, world;
+    float zoomLevel;
+    sf::View current;
+
+    void clamp() {
+        sf::Vector2f half = current.getSize() / 2.0f;
+        sf::Vector2f center = current.getCenter();
+        center.x = half.x * 2 >= world.x ? world.x / 2 : std::max(half.x, std::min(world.x - half.x, center.x));
+        center.y = half.y * 2 >= world.y ? world.y / 2 : std::max(half.y, std::min(world.y - half.y, center.y));
+        current.setCenter(center);
+    }
+};
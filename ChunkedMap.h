@@ -0,0 +1,327 @@
+//ChunkedMap.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "AssetManager.h"
+#include "MemoryTracker.h"
+#include "SpatialGrid.h"
+
+// Background map split into fixed-size tiles (see AtlasPacker --chunks). Only
+// tiles around the viewport are resident: a worker thread decodes requested
+// PNGs, update() uploads them on the render thread, and tiles that drift far
+// from the view are evicted. Memory is bounded by view size, not map size.
+// Resident tiles count toward the texture budget: while it is over, tiles
+// outside the view are dropped, farthest first, and no more are preloaded.
+class ChunkedMap : public sf::Drawable {
+public:
+    ChunkedMap() : chunkSize(0), columns(0), rows(0), archive(nullptr), running(false), residentMemory(AssetMemory, true) {}
+
+    ~ChunkedMap() {
+        stop();
+    }
+
+    ChunkedMap(const ChunkedMap&) = delete;
+
+    // Tiles found in the asset archive as pixels are uploaded straight from it;
+    // the rest are decoded on the worker, from the archive or loose files
+    bool load(const AssetManager& assets, const std::string& manifestFile, bool useArchive = true) {
+        std::string text, prefix;
+        int newChunkSize, newColumns, newRows;
+        sf::Vector2i newSize;
+        if (!assets.readFile(manifestFile, text, useArchive)) return false;
+        std::istringstream manifest(text);
+        if (!(manifest >> newChunkSize >> newColumns >> newRows >> newSize.x >> newSize.y >> prefix) || newChunkSize <= 0) {
+            return false;
+        }
+
+        stop();  // A reload keeps the old map until the new manifest checks out
+        chunkSize = newChunkSize;
+        columns = newColumns;
+        rows = newRows;
+        size = newSize;
+        tilePrefix = prefix;
+        manifestName = manifestFile;
+        directory = assets.root();
+        archive = useArchive && assets.archive().isOpen() ? &assets.archive() : nullptr;
+        chunks.clear();
+        chunks.resize(columns * rows);
+        residentMemory.set(0);
+        wanted.assign(chunks.size(), false);
+        looseOnly.assign(chunks.size(), false);
+        requests.clear();
+        decoded.clear();
+
+        running = true;
+        worker = std::thread(&ChunkedMap::decodeLoop, this);
+        return true;
+    }
+
+    // Hot reload, with the render thread held off. A changed tile is dropped and
+    // streams back in from its loose file; a changed manifest reloads the whole
+    // map. Returns false if the file isn't part of this map.
+    bool reload(const AssetManager& assets, const std::string& file) {
+        if (file == manifestName) return load(assets, manifestName, false);
+
+        int x, y;
+        char tail;
+        std::string prefix = tilePrefix + "_";
+        if (file.compare(0, prefix.size(), prefix) != 0 ||
+            std::sscanf(file.c_str() + prefix.size(), "%d_%d.pn%c", &x, &y, &tail) != 3 ||
+            x < 0 || x >= columns || y < 0 || y >= rows) {
+            return false;
+        }
+        int index = y * columns + x;
+        std::lock_guard<std::mutex> lock(mutex);
+        chunks[index].texture.reset();
+        chunks[index].state = Chunk::Unloaded;
+        residentMemory.set(residentBytes());
+        wanted[index] = false;
+        looseOnly[index] = true;  // The archive still holds the old tile
+        decoded.erase(std::remove_if(decoded.begin(), decoded.end(), [&](const std::pair<int, sf::Image>& tile) {
+            return tile.first == index;
+        }), decoded.end());
+        return true;
+    }
+
+    sf::Vector2f worldSize() const {
+        return sf::Vector2f(static_cast<float>(size.x), static_cast<float>(size.y));
+    }
+
+    // Render thread. Requests tiles near area, uploads finished decodes and
+    // evicts distant tiles. Returns true if the set of resident tiles changed.
+    bool update(const sf::FloatRect& area) {
+        if (chunks.empty()) return false;
+
+        int x0, y0, x1, y1;
+        chunkRange(area, preloadMargin, x0, y0, x1, y1);
+        int ex0, ey0, ex1, ey1;
+        chunkRange(area, evictMargin, ex0, ey0, ex1, ey1);
+        int vx0, vy0, vx1, vy1;
+        chunkRange(area, 0, vx0, vy0, vx1, vy1);
+
+        // Tiles beyond the view are preloaded only while the budget has room for them
+        size_t budget = textureBudget().limit();
+        size_t planned = textureBudget().resident();
+        size_t tileBytes = MemoryCharge::textureBytes(sf::Vector2u(chunkSize, chunkSize));
+
+        bool requested = false, uploadedFromArchive = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            arrived.swap(decoded);
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    int index = y * columns + x;
+                    if (chunks[index].state != Chunk::Unloaded) continue;
+                    if (x < vx0 || x > vx1 || y < vy0 || y > vy1) {
+                        if (budget != 0 && planned + tileBytes > budget) continue;
+                        planned += tileBytes;
+                    }
+                    if (archive && !looseOnly[index]) {
+                        const pak::Entry* packed = archive->find(tileName(index));
+                        if (packed && packed->type == pak::Rgba) {
+                            chunks[index].texture.reset(new sf::Texture());
+                            bool uploaded = AssetManager::uploadPacked(*chunks[index].texture, *packed, *archive);
+                            chunks[index].state = uploaded ? Chunk::Resident : Chunk::Missing;
+                            if (!uploaded) chunks[index].texture.reset();
+                            uploadedFromArchive |= uploaded;
+                            continue;
+                        }
+                    }
+                    chunks[index].state = Chunk::Queued;
+                    wanted[index] = true;
+                    requests.push_back(index);
+                    requested = true;
+                }
+            }
+            for (size_t i = 0; i < chunks.size(); i++) {
+                int x = static_cast<int>(i) % columns, y = static_cast<int>(i) / columns;
+                if (chunks[i].state == Chunk::Queued && (x < ex0 || x > ex1 || y < ey0 || y > ey1)) {
+                    chunks[i].state = Chunk::Unloaded;  // Scrolled away before it was decoded
+                    wanted[i] = false;
+                }
+            }
+        }
+        if (requested) wake.notify_one();
+
+        bool changed = uploadedFromArchive;
+        for (auto& tile : arrived) {
+            Chunk& chunk = chunks[tile.first];
+            if (chunk.state != Chunk::Queued) continue;
+            chunk.texture.reset(new sf::Texture());
+            if (chunk.texture->loadFromImage(tile.second)) {
+                chunk.state = Chunk::Resident;
+                changed = true;
+            } else {
+                chunk.texture.reset();
+                chunk.state = Chunk::Missing;
+            }
+        }
+        arrived.clear();  // Its capacity goes back to the worker on the next swap
+
+        for (size_t i = 0; i < chunks.size(); i++) {
+            int x = static_cast<int>(i) % columns, y = static_cast<int>(i) / columns;
+            if (chunks[i].state == Chunk::Resident && (x < ex0 || x > ex1 || y < ey0 || y > ey1)) {
+                chunks[i].texture.reset();
+                chunks[i].state = Chunk::Unloaded;
+                changed = true;
+            }
+        }
+        if (changed) residentMemory.set(residentBytes());
+        if (trimToBudget(vx0, vy0, vx1, vy1)) {
+            residentMemory.set(residentBytes());
+            changed = true;
+        }
+        return changed;
+    }
+
+    size_t residentCount() const {
+        size_t count = 0;
+        for (const auto& chunk : chunks) {
+            if (chunk.state == Chunk::Resident) count++;
+        }
+        return count;
+    }
+
+private:
+    static const int preloadMargin = 1;  // Tiles beyond the view decoded ahead of time
+    static const int evictMargin = 2;    // Tiles further out than this are dropped
+
+    struct Chunk {
+        enum State { Unloaded, Queued, Resident, Missing };
+        State state = Unloaded;
+        std::unique_ptr<sf::Texture> texture;
+    };
+
+    int chunkSize, columns, rows;
+    sf::Vector2i size;
+    std::string manifestName, directory, tilePrefix;
+    const AssetArchive* archive;
+    std::vector<Chunk> chunks;  // Render thread only, apart from state changes under mutex
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<int> requests;
+    std::vector<bool> wanted;
+    std::vector<bool> looseOnly;  // Tiles changed on disk since the archive was built
+    std::vector<std::pair<int, sf::Image>> decoded;
+    std::vector<std::pair<int, sf::Image>> arrived;  // Render thread; kept so neither vector reallocates
+    bool running;
+    std::thread worker;
+    MemoryCharge residentMemory;  // Pixels of the resident tiles
+
+    size_t residentBytes() const {
+        size_t bytes = 0;
+        for (const auto& chunk : chunks) {
+            if (chunk.texture) bytes += MemoryCharge::textureBytes(chunk.texture->getSize());
+        }
+        return bytes;
+    }
+
+    // Drops resident tiles outside the view range, farthest from it first,
+    // until the texture budget is no longer over. Tiles in view always stay.
+    bool trimToBudget(int x0, int y0, int x1, int y1) {
+        size_t excess = textureBudget().excess();
+        if (excess == 0) return false;
+
+        std::vector<std::pair<int, int>> candidates;  // Distance in tiles, index
+        for (size_t i = 0; i < chunks.size(); i++) {
+            if (chunks[i].state != Chunk::Resident) continue;
+            int x = static_cast<int>(i) % columns, y = static_cast<int>(i) / columns;
+            int distance = std::max(std::max(x0 - x, x - x1), std::max(y0 - y, y - y1));
+            if (distance > 0) candidates.emplace_back(distance, static_cast<int>(i));
+        }
+        std::sort(candidates.begin(), candidates.end(), std::greater<std::pair<int, int>>());
+
+        size_t freed = 0;
+        for (const auto& candidate : candidates) {
+            if (freed >= excess) break;
+            Chunk& chunk = chunks[candidate.second];
+            freed += MemoryCharge::textureBytes(chunk.texture->getSize());
+            chunk.texture.reset();
+            chunk.state = Chunk::Unloaded;
+        }
+        return freed > 0;
+    }
+
+    void stop() {
+        if (!running) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    void chunkRange(const sf::FloatRect& area, int margin, int& x0, int& y0, int& x1, int& y1) const {
+        x0 = std::max(0, static_cast<int>(area.left) / chunkSize - margin);
+        y0 = std::max(0, static_cast<int>(area.top) / chunkSize - margin);
+        x1 = std::min(columns - 1, static_cast<int>(area.left + area.width) / chunkSize + margin);
+        y1 = std::min(rows - 1, static_cast<int>(area.top + area.height) / chunkSize + margin);
+    }
+
+    std::string tileName(int index) const {
+        return tilePrefix + "_" + std::to_string(index % columns) + "_" + std::to_string(index / columns) + ".png";
+    }
+
+    void decodeLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running) {
+            if (requests.empty()) {
+                wake.wait(lock);
+                continue;
+            }
+            int index = requests.front();
+            requests.pop_front();
+            if (!wanted[index]) continue;
+            const pak::Entry* packed = archive && !looseOnly[index] ? archive->find(tileName(index)) : nullptr;
+
+            lock.unlock();
+            sf::Image image;  // Left empty on failure, which marks the tile missing
+            if (packed) {
+                image.loadFromMemory(archive->data(*packed), packed->size);  // A PNG kept compressed
+            } else {
+                image.loadFromFile(directory + tileName(index));
+            }
+            lock.lock();
+
+            if (wanted[index]) {
+                wanted[index] = false;
+                decoded.emplace_back(index, std::move(image));
+            }
+        }
+    }
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
+        sf::FloatRect area = visibleArea(target.getView());
+        for (size_t i = 0; i < chunks.size(); i++) {
+            if (chunks[i].state != Chunk::Resident) continue;
+            sf::Vector2u tileSize = chunks[i].texture->getSize();
+            sf::Vector2f position(static_cast<float>(i % columns * chunkSize), static_cast<float>(i / columns * chunkSize));
+            if (!area.intersects(sf::FloatRect(position.x, position.y, static_cast<float>(tileSize.x), static_cast<float>(tileSize.y)))) {
+                continue;
+            }
+
+            sf::Vector2f tex(static_cast<float>(tileSize.x), static_cast<float>(tileSize.y));
+            sf::Vertex quad[4] = {
+                sf::Vertex(position, sf::Vector2f(0, 0)),
+                sf::Vertex(sf::Vector2f(position.x + tex.x, position.y), sf::Vector2f(tex.x, 0)),
+                sf::Vertex(position + tex, tex),
+                sf::Vertex(sf::Vector2f(position.x, position.y + tex.y), sf::Vector2f(0, tex.y))
+            };
+            states.texture = chunks[i].texture.get();
+            target.draw(quad, 4, sf::Quads, states);
+        }
+    }
+};
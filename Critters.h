@@ -0,0 +1,38 @@
+//Critters.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Ambient animals that scroll across the screen and wrap around
+struct Critter {
+    size_t animation;   // Instance id in the shared Animator
+    sf::Vector2f position;
+    float speed;        // Pixels per second along x, negative moves left
+    float wrapAt;       // Once x passes this it jumps back to respawnAt
+    float respawnAt;
+    bool flipped;       // Mirrored horizontally, extending left of position
+};
+
+class Critters {
+public:
+    void add(const Critter& critter) {
+        critters.push_back(critter);
+    }
+
+    void update(float deltaTime) {
+        for (auto& critter : critters) {
+            critter.position.x += critter.speed * deltaTime;
+            if ((critter.speed < 0 && critter.position.x < critter.wrapAt) ||
+                (critter.speed > 0 && critter.position.x > critter.wrapAt)) {
+                critter.position.x = critter.respawnAt;
+            }
+        }
+    }
+
+    const std::vector<Critter>& all() const {
+        return critters;
+    }
+
+private:
+    std::vector<Critter> critters;
+};
@@ -0,0 +1,99 @@
+//EnemyRenderer.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include "Arena.h"
+#include "Atlas.h"
+#include "MemoryTracker.h"
+
+// Draws every live enemy and its health bar from one persistent vertex buffer.
+// Bodies come first and bars after, so all bars stay on top; when both regions
+// share an atlas page the whole lot is a single draw call. Enemy sprites are
+// expected to share one page. Quads are staged in a per-frame arena; clear()
+// must be called after every reset of it.
+class EnemyRenderer : public sf::Drawable {
+public:
+    EnemyRenderer(const Atlas& atlas, Arena& frameArena)
+    : atlas(atlas), arena(frameArena), bodyPage(nullptr), bodies(frameArena), bars(frameArena),
+      buffer(sf::Quads, sf::VertexBuffer::Stream), quadCount(0), bufferMemory(RenderMemory) {}
+
+    void clear() {
+        bodies = ArenaVector<sf::Vertex>(arena);
+        bars = ArenaVector<sf::Vertex>(arena);
+    }
+
+    // healthFraction is current health over max health
+    void add(sf::Vector2f position, float healthFraction, atlas::Sprite sprite, float scale) {
+        sf::IntRect body = Atlas::rect(sprite);
+        bodyPage = &atlas.texture(sprite);
+        appendQuad(bodies, position, sf::Vector2f(body.width * scale, body.height * scale), body, sf::Color::White);
+
+        float barWidth = maxBarWidth * std::max(0.0f, healthFraction);
+        appendQuad(bars, sf::Vector2f(position.x, position.y - barOffset), sf::Vector2f(barWidth, barHeight),
+                   Atlas::rect(atlas::White), sf::Color::Red);
+    }
+
+    // Copies this frame's quads into the GPU buffer, growing it only when needed
+    void upload() {
+        quadCount = (bodies.size() + bars.size()) / 4;
+        if (!sf::VertexBuffer::isAvailable() || quadCount == 0) return;
+
+        if (buffer.getVertexCount() < quadCount * 4) {
+            buffer.create(std::max(quadCount * 4, buffer.getVertexCount() * 2));
+            bufferMemory.set(buffer.getVertexCount() * sizeof(sf::Vertex));
+        }
+        buffer.update(bodies.data(), bodies.size(), 0);
+        buffer.update(bars.data(), bars.size(), static_cast<unsigned int>(bodies.size()));
+    }
+
+    size_t size() const {
+        return bodies.size() / 4;
+    }
+
+private:
+    static constexpr float maxBarWidth = 80.0f;
+    static constexpr float barHeight = 5.0f;
+    static constexpr float barOffset = 10.0f;
+
+    const Atlas& atlas;
+    Arena& arena;
+    const sf::Texture* bodyPage;
+    ArenaVector<sf::Vertex> bodies, bars;  // Staging for this frame
+    sf::VertexBuffer buffer;
+    size_t quadCount;
+    MemoryCharge bufferMemory;
+
+    static void appendQuad(ArenaVector<sf::Vertex>& out, sf::Vector2f position, sf::Vector2f size,
+                           const sf::IntRect& rect, sf::Color color) {
+        float left = static_cast<float>(rect.left), top = static_cast<float>(rect.top);
+        float right = left + rect.width, bottom = top + rect.height;
+        out.emplace_back(position, color, sf::Vector2f(left, top));
+        out.emplace_back(sf::Vector2f(position.x + size.x, position.y), color, sf::Vector2f(right, top));
+        out.emplace_back(position + size, color, sf::Vector2f(right, bottom));
+        out.emplace_back(sf::Vector2f(position.x, position.y + size.y), color, sf::Vector2f(left, bottom));
+    }
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
+        if (quadCount == 0) return;
+
+        const sf::Texture* barPage = &atlas.texture(atlas::White);
+        size_t bodyVertices = bodies.size(), barVertices = bars.size();
+
+        if (!sf::VertexBuffer::isAvailable()) {
+            states.texture = bodyPage;
+            target.draw(bodies.data(), bodyVertices, sf::Quads, states);
+            states.texture = barPage;
+            target.draw(bars.data(), barVertices, sf::Quads, states);
+            return;
+        }
+
+        states.texture = bodyPage;
+        if (bodyPage == barPage) {
+            target.draw(buffer, 0, bodyVertices + barVertices, states);
+            return;
+        }
+        target.draw(buffer, 0, bodyVertices, states);
+        states.texture = barPage;
+        target.draw(buffer, bodyVertices, barVertices, states);
+    }
+};
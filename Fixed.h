@@ -0,0 +1,144 @@
+//Fixed.h
+#pragma once
+#include <SFML/System.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+// Q16.16 fixed-point number: integer arithmetic only, so the same inputs give
+// bit-identical results on every compiler, optimisation level and FPU. Range is
+// about +-32767 with a resolution of 1/65536. Products and quotients go through
+// 64 bits; results that don't fit wrap, so keep values in world-sized units.
+class Fixed {
+public:
+    static const int fractionBits = 16;
+    static const std::int32_t one = 1 << fractionBits;
+
+    Fixed() : raw(0) {}
+    Fixed(int value) : raw(static_cast<std::int32_t>(value * one)) {}  // Implicit, so Scalar(5) works for float too
+
+    // Floats are only converted at the edges (constants, input, rendering)
+    static Fixed fromFloat(float value) {
+        return fromRaw(static_cast<std::int32_t>(std::lround(value * one)));
+    }
+
+    static Fixed fromRaw(std::int32_t value) {
+        Fixed fixed;
+        fixed.raw = value;
+        return fixed;
+    }
+
+    float toFloat() const {
+        return static_cast<float>(raw) / one;
+    }
+
+    std::int32_t rawValue() const {
+        return raw;
+    }
+
+    Fixed operator-() const { return fromRaw(-raw); }
+    Fixed operator+(Fixed other) const { return fromRaw(raw + other.raw); }
+    Fixed operator-(Fixed other) const { return fromRaw(raw - other.raw); }
+    Fixed operator*(Fixed other) const {
+        return fromRaw(static_cast<std::int32_t>((static_cast<std::int64_t>(raw) * other.raw) >> fractionBits));
+    }
+    Fixed operator/(Fixed other) const {
+        return fromRaw(static_cast<std::int32_t>((static_cast<std::int64_t>(raw) << fractionBits) / other.raw));
+    }
+
+    Fixed& operator+=(Fixed other) { return *this = *this + other; }
+    Fixed& operator-=(Fixed other) { return *this = *this - other; }
+    Fixed& operator*=(Fixed other) { return *this = *this * other; }
+    Fixed& operator/=(Fixed other) { return *this = *this / other; }
+
+    bool operator==(Fixed other) const { return raw == other.raw; }
+    bool operator!=(Fixed other) const { return raw != other.raw; }
+    bool operator<(Fixed other) const { return raw < other.raw; }
+    bool operator<=(Fixed other) const { return raw <= other.raw; }
+    bool operator>(Fixed other) const { return raw > other.raw; }
+    bool operator>=(Fixed other) const { return raw >= other.raw; }
+
+private:
+    std::int32_t raw;
+};
+
+namespace fixed {
+    // floor(sqrt(value)), bit by bit
+    inline std::uint64_t isqrt(std::uint64_t value) {
+        std::uint64_t result = 0;
+        std::uint64_t bit = std::uint64_t(1) << 62;
+        while (bit > value) bit >>= 2;
+        while (bit) {
+            if (value >= result + bit) {
+                value -= result + bit;
+                result = (result >> 1) + bit;
+            } else {
+                result >>= 1;
+            }
+            bit >>= 2;
+        }
+        return result;
+    }
+
+    // Squares of raw components; each is below 2^62, so two of them fit
+    inline std::uint64_t rawLengthSquared(std::int64_t x, std::int64_t y) {
+        return static_cast<std::uint64_t>(x * x) + static_cast<std::uint64_t>(y * y);
+    }
+}
+
+// The simulation's number type: float by default, Fixed when the build is
+// configured with GLOOM_FIXED_POINT=ON. Sim code writes Scalar(n) for whole
+// constants and toScalar() for fractional ones so it compiles either way.
+#ifdef GLOOM_FIXED_POINT
+using Scalar = Fixed;
+
+inline Scalar toScalar(float value) {
+    return Fixed::fromFloat(value);
+}
+
+inline float toFloat(Fixed value) {
+    return value.toFloat();
+}
+
+inline Fixed length(const sf::Vector2<Fixed>& vector) {
+    std::uint64_t root = fixed::isqrt(fixed::rawLengthSquared(vector.x.rawValue(), vector.y.rawValue()));
+    return Fixed::fromRaw(static_cast<std::int32_t>(root > INT32_MAX ? INT32_MAX : root));
+}
+
+// |a - b| <= range without a square root or any rounding
+inline bool withinDistance(const sf::Vector2<Fixed>& a, const sf::Vector2<Fixed>& b, Fixed range) {
+    std::int64_t dx = std::llabs(static_cast<std::int64_t>(a.x.rawValue()) - b.x.rawValue());
+    std::int64_t dy = std::llabs(static_cast<std::int64_t>(a.y.rawValue()) - b.y.rawValue());
+    std::int64_t limit = range.rawValue();
+    if (dx > limit || dy > limit) return false;  // Also keeps the squares below from overflowing
+    return fixed::rawLengthSquared(dx, dy) <= static_cast<std::uint64_t>(limit * limit);
+}
+#else
+using Scalar = float;
+
+inline Scalar toScalar(float value) {
+    return value;
+}
+
+inline float toFloat(float value) {
+    return value;
+}
+
+inline float length(const sf::Vector2f& vector) {
+    return std::sqrt(vector.x * vector.x + vector.y * vector.y);
+}
+
+inline bool withinDistance(const sf::Vector2f& a, const sf::Vector2f& b, float range) {
+    return std::sqrt(std::pow(a.x - b.x, 2) + std::pow(a.y - b.y, 2)) <= range;
+}
+#endif
+
+using SimVector = sf::Vector2<Scalar>;
+
+inline SimVector toSimVector(const sf::Vector2f& vector) {
+    return SimVector(toScalar(vector.x), toScalar(vector.y));
+}
+
+inline sf::Vector2f toFloat(const SimVector& vector) {
+    return sf::Vector2f(toFloat(vector.x), toFloat(vector.y));
+}
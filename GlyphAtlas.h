@@ -0,0 +1,171 @@
+//GlyphAtlas.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "MemoryTracker.h"
+
+// Printable ASCII from one font at one size, rasterised once into a texture of
+// its own. Later glyph requests on the font (other text, a hot reload) can't
+// grow or move the page underneath, so laid-out text stays valid.
+class GlyphAtlas {
+public:
+    struct Glyph {
+        float advance;
+        sf::FloatRect bounds;  // Relative to the pen position on the baseline
+        sf::IntRect rect;      // On the page
+    };
+
+    static const char firstChar = ' ', lastChar = '~';
+
+    GlyphAtlas() : size(0), lineHeight(0.0f), digitWidth(0.0f), pageMemory(RenderMemory) {}
+
+    bool bake(const sf::Font& font, unsigned int characterSize) {
+        for (char c = firstChar; c <= lastChar; c++) {
+            const sf::Glyph& glyph = font.getGlyph(static_cast<sf::Uint32>(c), characterSize, false);
+            glyphs[c - firstChar] = {glyph.advance, glyph.bounds, glyph.textureRect};
+        }
+        page = font.getTexture(characterSize);  // Copy, now that every glyph is on it
+        pageMemory.set(MemoryCharge::textureBytes(page.getSize()));
+        size = characterSize;
+        lineHeight = font.getLineSpacing(characterSize);
+        digitWidth = 0.0f;
+        for (char c = '0'; c <= '9'; c++) {
+            digitWidth = std::max(digitWidth, glyph(c).advance);
+        }
+        return page.getSize().x > 0;
+    }
+
+    bool isBaked() const {
+        return size != 0;
+    }
+
+    // Anything outside printable ASCII comes out as '?'
+    const Glyph& glyph(char c) const {
+        return glyphs[(c < firstChar || c > lastChar ? '?' : c) - firstChar];
+    }
+
+    const sf::Texture& texture() const {
+        return page;
+    }
+
+    unsigned int characterSize() const {
+        return size;
+    }
+
+    float lineSpacing() const {
+        return lineHeight;
+    }
+
+    // Digits are laid out on a fixed pitch so numbers can change in place
+    float digitAdvance() const {
+        return digitWidth;
+    }
+
+    float measure(const std::string& text) const {
+        float width = 0.0f;
+        for (char c : text) {
+            width += glyph(c).advance;
+        }
+        return width;
+    }
+
+private:
+    Glyph glyphs[lastChar - firstChar + 1];
+    sf::Texture page;
+    unsigned int size;
+    float lineHeight;
+    float digitWidth;
+    MemoryCharge pageMemory;
+};
+
+// Text from one GlyphAtlas in a single vertex array and a single draw call.
+// Strings are laid out once when added. Numeric fields own a fixed run of digit
+// slots whose quads are rewritten in place, so changing a counter every frame
+// never re-lays out or reallocates anything.
+class TextBatch : public sf::Drawable {
+public:
+    TextBatch(const GlyphAtlas& glyphs) : glyphs(glyphs) {}
+
+    void clear() {
+        vertices.clear();
+        fields.clear();
+    }
+
+    // position is the top-left of the line, as with sf::Text
+    void addText(sf::Vector2f position, const std::string& text, sf::Color color) {
+        float baseline = position.y + glyphs.characterSize();
+        for (char c : text) {
+            appendGlyph(vertices, sf::Vector2f(position.x, baseline), glyphs.glyph(c), color);
+            position.x += glyphs.glyph(c).advance;
+        }
+    }
+
+    // Reserves digits right-aligned slots and returns the field's id
+    size_t addNumber(sf::Vector2f position, unsigned int digits, sf::Color color) {
+        fields.push_back({vertices.size(), digits, position, color, -1});
+        vertices.resize(vertices.size() + digits * 4);
+        setNumber(fields.size() - 1, 0);
+        return fields.size() - 1;
+    }
+
+    // Clamped to what the field's digits can show
+    void setNumber(size_t field, int value) {
+        Field& number = fields[field];
+        int limit = 1;
+        for (unsigned int i = 0; i < number.digits; i++) limit *= 10;
+        value = std::min(std::max(value, 0), limit - 1);
+        if (value == number.value) return;
+        number.value = value;
+
+        float baseline = number.position.y + glyphs.characterSize();
+        float pitch = glyphs.digitAdvance();
+        for (unsigned int slot = number.digits; slot-- > 0; value /= 10) {
+            sf::Vertex* quad = &vertices[number.firstVertex + slot * 4];
+            bool blank = value == 0 && slot != number.digits - 1;  // No leading zeros
+            const GlyphAtlas::Glyph& digit = glyphs.glyph(static_cast<char>('0' + value % 10));
+            float x = number.position.x + slot * pitch + (pitch - digit.advance) / 2;
+            writeGlyph(quad, sf::Vector2f(x, baseline), digit, blank ? sf::Color::Transparent : number.color);
+        }
+    }
+
+private:
+    struct Field {
+        size_t firstVertex;
+        unsigned int digits;
+        sf::Vector2f position;
+        sf::Color color;
+        int value;
+    };
+
+    const GlyphAtlas& glyphs;
+    std::vector<sf::Vertex> vertices;
+    std::vector<Field> fields;
+
+    static void appendGlyph(std::vector<sf::Vertex>& out, sf::Vector2f pen, const GlyphAtlas::Glyph& glyph, sf::Color color) {
+        out.resize(out.size() + 4);
+        writeGlyph(&out[out.size() - 4], pen, glyph, color);
+    }
+
+    // Same one-texel padding around each glyph that sf::Text uses
+    static void writeGlyph(sf::Vertex* quad, sf::Vector2f pen, const GlyphAtlas::Glyph& glyph, sf::Color color) {
+        const float padding = 1.0f;
+        float left = pen.x + glyph.bounds.left - padding;
+        float top = pen.y + glyph.bounds.top - padding;
+        float right = pen.x + glyph.bounds.left + glyph.bounds.width + padding;
+        float bottom = pen.y + glyph.bounds.top + glyph.bounds.height + padding;
+        float u1 = glyph.rect.left - padding, v1 = glyph.rect.top - padding;
+        float u2 = glyph.rect.left + glyph.rect.width + padding, v2 = glyph.rect.top + glyph.rect.height + padding;
+        quad[0] = sf::Vertex(sf::Vector2f(left, top), color, sf::Vector2f(u1, v1));
+        quad[1] = sf::Vertex(sf::Vector2f(right, top), color, sf::Vector2f(u2, v1));
+        quad[2] = sf::Vertex(sf::Vector2f(right, bottom), color, sf::Vector2f(u2, v2));
+        quad[3] = sf::Vertex(sf::Vector2f(left, bottom), color, sf::Vector2f(u1, v2));
+    }
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
+        if (vertices.empty()) return;
+        states.texture = &glyphs.texture();
+        target.draw(vertices.data(), vertices.size(), sf::Quads, states);
+    }
+};
@@ -0,0 +1,41 @@
+//LoadingScreen.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <atomic>
+
+// Shown from the first frame until the critical assets are in. Needs no assets
+// of its own: just a progress bar, so it can go up before anything has loaded.
+// The loading thread sets the progress and the render thread draws it.
+class LoadingScreen {
+public:
+    LoadingScreen() : progress(0.0f) {
+        frame.setSize(barSize);
+        frame.setFillColor(sf::Color::Transparent);
+        frame.setOutlineColor(sf::Color::White);
+        frame.setOutlineThickness(2.0f);
+        bar.setFillColor(sf::Color::White);
+    }
+
+    // 0 to 1
+    void setProgress(float fraction) {
+        progress.store(fraction, std::memory_order_relaxed);
+    }
+
+    void draw(sf::RenderTarget& target) {
+        target.setView(target.getDefaultView());
+        target.clear();
+
+        sf::Vector2f center = target.getDefaultView().getCenter();
+        frame.setPosition(center - barSize / 2.0f);
+        bar.setPosition(frame.getPosition());
+        bar.setSize(sf::Vector2f(barSize.x * progress.load(std::memory_order_relaxed), barSize.y));
+        target.draw(frame);
+        target.draw(bar);
+    }
+
+private:
+    const sf::Vector2f barSize = sf::Vector2f(600.0f, 24.0f);
+
+    std::atomic<float> progress;
+    sf::RectangleShape frame, bar;
+};
@@ -0,0 +1,213 @@
+//Log.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+enum class LogLevel {
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+// Lets a call site through at most burst times per second and counts the rest,
+// so a message inside the tick loop can't flood the log. A burst of unlimited
+// lets everything through, for lines that must not have gaps.
+class LogRateLimit {
+public:
+    static const int defaultBurst = 5;
+    static const int unlimited = 0;
+
+    explicit LogRateLimit(int burst = defaultBurst) : burst(burst), window(0), count(0), suppressed(0) {}
+
+    bool allow(std::int64_t nowMs) {
+        if (burst == unlimited) return true;
+        std::int64_t second = nowMs / 1000;
+        std::int64_t current = window.load(std::memory_order_relaxed);
+        if (second != current && window.compare_exchange_strong(current, second, std::memory_order_relaxed)) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        if (count.fetch_add(1, std::memory_order_relaxed) < burst) return true;
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // How many were dropped since the last call
+    int takeSuppressed() {
+        return suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    const int burst;
+    std::atomic<std::int64_t> window;  // Second the count applies to
+    std::atomic<int> count;
+    std::atomic<int> suppressed;
+};
+
+// Asynchronous logger. Any thread formats its line into a slot of a fixed ring
+// (a bounded lock-free multi-producer queue) and returns; a background thread
+// writes the lines out. Producers never wait and never allocate: when the ring
+// is full the line is dropped and counted. Use through the LOG_* macros.
+class Logger {
+public:
+    static const size_t capacity = 1024;  // Power of two
+    static const size_t lineLength = 240;
+
+    Logger() : out(stderr), minimum(LogLevel::Info), start(std::chrono::steady_clock::now()),
+               enqueuePosition(0), dequeuePosition(0), dropped(0), running(true) {
+        for (size_t i = 0; i < capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        writer = std::thread([this] { writeLoop(); });
+    }
+
+    // Writes out everything still queued
+    ~Logger() {
+        running = false;
+        writer.join();
+    }
+
+    Logger(const Logger&) = delete;
+
+    void setLevel(LogLevel level) {
+        minimum.store(level, std::memory_order_relaxed);
+    }
+
+    bool enabled(LogLevel level) const {
+        return level >= minimum.load(std::memory_order_relaxed);
+    }
+
+    std::int64_t elapsedMs() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+#if defined(__GNUC__)
+    __attribute__((format(printf, 4, 5)))
+#endif
+    void write(LogLevel level, LogRateLimit& limit, const char* format, ...) {
+        std::int64_t now = elapsedMs();
+        if (!limit.allow(now)) return;
+
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[position & (capacity - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (difference < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);  // Full; the writer is behind
+                return;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->level = level;
+        slot->timeMs = now;
+        va_list args;
+        va_start(args, format);
+        int length = std::vsnprintf(slot->text, lineLength, format, args);
+        va_end(args);
+        int suppressed = limit.takeSuppressed();
+        if (suppressed > 0 && length >= 0 && static_cast<size_t>(length) < lineLength) {
+            std::snprintf(slot->text + length, lineLength - length, " (%d similar suppressed)", suppressed);
+        }
+        slot->sequence.store(position + 1, std::memory_order_release);
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;  // position + 1 once filled, position + capacity once written out
+        LogLevel level;
+        std::int64_t timeMs;
+        char text[lineLength];
+    };
+
+    std::FILE* out;
+    std::atomic<LogLevel> minimum;
+    std::chrono::steady_clock::time_point start;
+    Slot slots[capacity];
+    alignas(64) std::atomic<size_t> enqueuePosition;
+    alignas(64) size_t dequeuePosition;  // Writer thread only
+    std::atomic<unsigned long> dropped;
+    std::atomic<bool> running;
+    std::thread writer;
+
+    static const char* levelName(LogLevel level) {
+        switch (level) {
+            case LogLevel::Debug: return "debug";
+            case LogLevel::Info: return "info";
+            case LogLevel::Warning: return "warning";
+            default: return "error";
+        }
+    }
+
+    // Returns how many lines were written
+    size_t drain() {
+        size_t written = 0;
+        for (;;) {
+            Slot& slot = slots[dequeuePosition & (capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) break;
+            std::fprintf(out, "[%7.3f] %-7s %s\n", slot.timeMs / 1000.0, levelName(slot.level), slot.text);
+            slot.sequence.store(dequeuePosition + capacity, std::memory_order_release);
+            dequeuePosition++;
+            written++;
+        }
+        if (unsigned long lost = dropped.exchange(0, std::memory_order_relaxed)) {
+            std::fprintf(out, "[%7.3f] %-7s %lu log lines dropped, queue full\n", elapsedMs() / 1000.0, "warning", lost);
+            written++;
+        }
+        if (written) std::fflush(out);
+        return written;
+    }
+
+    void writeLoop() {
+        while (running) {
+            if (drain() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        drain();
+    }
+};
+
+inline bool parseLogLevel(const char* name, LogLevel& level) {
+    const char* names[] = {"debug", "info", "warning", "error"};
+    for (int i = 0; i < 4; i++) {
+        if (std::strcmp(name, names[i]) == 0) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+inline Logger& logger() {
+    static Logger instance;
+    return instance;
+}
+
+// printf-style; each call site gets its own rate limit of burst lines a second
+#define GLOOM_LOG_BURST(level, burst, ...)                          \
+    do {                                                            \
+        static LogRateLimit gloomLogLimit(burst);                   \
+        if (logger().enabled(level)) {                              \
+            logger().write(level, gloomLogLimit, __VA_ARGS__);      \
+        }                                                           \
+    } while (0)
+
+#define GLOOM_LOG(level, ...) GLOOM_LOG_BURST(level, LogRateLimit::defaultBurst, __VA_ARGS__)
+
+#define LOG_DEBUG(...) GLOOM_LOG(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) GLOOM_LOG(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARNING(...) GLOOM_LOG(LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) GLOOM_LOG(LogLevel::Error, __VA_ARGS__)
+
+// Every line, for traces that are compared line by line; the ring can still drop
+// lines if the writer falls behind, and says so
+#define LOG_DEBUG_ALL(...) GLOOM_LOG_BURST(LogLevel::Debug, LogRateLimit::unlimited, __VA_ARGS__)
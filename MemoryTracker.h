@@ -0,0 +1,199 @@
+//MemoryTracker.h
+#pragma once
+#include <SFML/System.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// Subsystems memory is charged to
+enum MemoryTag {
+    SimMemory,
+    RenderMemory,
+    AssetMemory,
+    AudioMemory,
+    ReplayMemory,
+    MemoryTagCount
+};
+
+const char* const memoryTagNames[MemoryTagCount] = {"sim", "render", "assets", "audio", "replay"};
+
+// Live and peak bytes per tag, safe to update from any thread. Heap memory is
+// charged by TaggedAllocator; memory SFML owns (texture pixels, vertex
+// buffers, sound samples) is charged by its owner through a MemoryCharge, at
+// 4 bytes per texel for textures whether they sit on the GPU or in RAM.
+class MemoryTracker {
+public:
+    MemoryTracker() {
+        for (int i = 0; i < MemoryTagCount; i++) {
+            liveBytes[i].store(0, std::memory_order_relaxed);
+            peakBytes[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void add(MemoryTag tag, size_t bytes) {
+        size_t now = liveBytes[tag].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = peakBytes[tag].load(std::memory_order_relaxed);
+        while (now > peak && !peakBytes[tag].compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+    }
+
+    void remove(MemoryTag tag, size_t bytes) {
+        liveBytes[tag].fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    size_t live(MemoryTag tag) const {
+        return liveBytes[tag].load(std::memory_order_relaxed);
+    }
+
+    size_t peak(MemoryTag tag) const {
+        return peakBytes[tag].load(std::memory_order_relaxed);
+    }
+
+    // One line per tag: memory <tag> <live KiB> <peak KiB>
+    void report(std::FILE* out) const {
+        size_t totalLive = 0, totalPeak = 0;
+        for (int i = 0; i < MemoryTagCount; i++) {
+            MemoryTag tag = static_cast<MemoryTag>(i);
+            std::fprintf(out, "memory %-8s %10zu %10zu\n", memoryTagNames[i], live(tag) / 1024, peak(tag) / 1024);
+            totalLive += live(tag);
+            totalPeak += peak(tag);
+        }
+        std::fprintf(out, "memory %-8s %10zu %10zu\n", "total", totalLive / 1024, totalPeak / 1024);
+        std::fflush(out);
+    }
+
+private:
+    std::atomic<size_t> liveBytes[MemoryTagCount];
+    std::atomic<size_t> peakBytes[MemoryTagCount];
+};
+
+inline MemoryTracker& memoryTracker() {
+    static MemoryTracker instance;
+    return instance;
+}
+
+// Standard allocator that charges what it hands out to Tag
+template <typename T, MemoryTag Tag>
+class TaggedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = TaggedAllocator<U, Tag>;
+    };
+
+    TaggedAllocator() noexcept {}
+
+    template <typename U>
+    TaggedAllocator(const TaggedAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t count) {
+        T* memory = std::allocator<T>().allocate(count);
+        memoryTracker().add(Tag, count * sizeof(T));
+        return memory;
+    }
+
+    void deallocate(T* memory, size_t count) noexcept {
+        memoryTracker().remove(Tag, count * sizeof(T));
+        std::allocator<T>().deallocate(memory, count);
+    }
+
+    template <typename U>
+    bool operator==(const TaggedAllocator<U, Tag>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const TaggedAllocator<U, Tag>&) const noexcept {
+        return false;
+    }
+};
+
+template <typename T, MemoryTag Tag>
+using TaggedVector = std::vector<T, TaggedAllocator<T, Tag>>;
+
+// Texture pixels their owners can give back (asset textures, map tiles) and
+// the limit they share, set by --texture-budget; 0 for no limit. Owners charge
+// it through a budgeted MemoryCharge and shed what they aren't drawing while
+// it is over. Any thread.
+class TextureBudget {
+public:
+    TextureBudget() : limitBytes(0), residentBytes(0) {}
+
+    void setLimit(size_t bytes) {
+        limitBytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    size_t limit() const {
+        return limitBytes.load(std::memory_order_relaxed);
+    }
+
+    size_t resident() const {
+        return residentBytes.load(std::memory_order_relaxed);
+    }
+
+    // Bytes past the limit; 0 under it or without one
+    size_t excess() const {
+        size_t cap = limit(), now = resident();
+        return cap != 0 && now > cap ? now - cap : 0;
+    }
+
+    void add(size_t bytes) {
+        residentBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void remove(size_t bytes) {
+        residentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<size_t> limitBytes;
+    std::atomic<size_t> residentBytes;
+};
+
+inline TextureBudget& textureBudget() {
+    static TextureBudget instance;
+    return instance;
+}
+
+// A fixed amount charged to a tag for as long as the owner wants, for memory
+// the owner can size but doesn't allocate itself (an sf::Texture's pixels).
+// A budgeted charge also counts toward the TextureBudget.
+class MemoryCharge {
+public:
+    explicit MemoryCharge(MemoryTag tag, bool budgeted = false) : tag(tag), budgeted(budgeted), bytes(0) {}
+
+    ~MemoryCharge() {
+        set(0);
+    }
+
+    MemoryCharge(const MemoryCharge&) = delete;
+    MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+    void set(size_t newBytes) {
+        if (newBytes > bytes) {
+            memoryTracker().add(tag, newBytes - bytes);
+            if (budgeted) textureBudget().add(newBytes - bytes);
+        }
+        if (newBytes < bytes) {
+            memoryTracker().remove(tag, bytes - newBytes);
+            if (budgeted) textureBudget().remove(bytes - newBytes);
+        }
+        bytes = newBytes;
+    }
+
+    size_t get() const {
+        return bytes;
+    }
+
+    static size_t textureBytes(const sf::Vector2u& size) {
+        return static_cast<size_t>(size.x) * size.y * 4;
+    }
+
+private:
+    MemoryTag tag;
+    bool budgeted;
+    size_t bytes;
+};
@@ -0,0 +1,316 @@
+//Metrics.h
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0  // macOS; SIGPIPE is only a risk if the scraper hangs up early
+#endif
+#endif
+
+enum MetricCounter {
+    EnemiesSpawned,
+    EnemiesKilled,
+    TowerShots,
+    BaseDamageTaken,
+    MetricCounterCount
+};
+
+enum MetricGauge {
+    EnemiesAlive,
+    MetricGaugeCount
+};
+
+enum MetricHistogram {
+    FrameTime,
+    TickTime,
+    MetricHistogramCount
+};
+
+struct MetricInfo {
+    const char* name;
+    const char* help;
+};
+
+const MetricInfo counterInfo[MetricCounterCount] = {
+    {"gloom_enemies_spawned_total", "Enemies spawned"},
+    {"gloom_enemies_killed_total", "Enemies killed by towers"},
+    {"gloom_tower_shots_total", "Shots fired by towers"},
+    {"gloom_base_damage_total", "Damage taken by the base"}
+};
+
+const MetricInfo gaugeInfo[MetricGaugeCount] = {
+    {"gloom_enemies_alive", "Enemies currently alive"}
+};
+
+const MetricInfo histogramInfo[MetricHistogramCount] = {
+    {"gloom_frame_seconds", "Time between presented frames"},
+    {"gloom_tick_seconds", "Time spent in one simulation tick"}
+};
+
+// Counters, gauges and latency histograms for the whole process. Each thread
+// updates its own cache-line-aligned shard with relaxed atomics, so recording
+// is an uncontended add; prometheusText() sums the shards. Histograms are
+// HDR-style: four linear sub-buckets per power of two microseconds, so every
+// bucket is within 25% of its value from 16 us to about 17 minutes. Samples
+// are rounded up to whole microseconds and each bucket holds the samples
+// <= its limit, matching Prometheus' cumulative le buckets.
+class Metrics {
+public:
+    static constexpr int maxShards = 16;        // Threads past this share the last shard
+    static constexpr int subBuckets = 4;
+    static constexpr int firstOctave = 4;       // 2^4 us; faster lands in bucket 0
+    static constexpr int octaves = 26;
+    static constexpr int bucketCount = 1 + octaves * subBuckets;
+
+    Metrics() : shardCount(0) {
+        for (auto& gauge : gauges) gauge.store(0, std::memory_order_relaxed);
+    }
+
+    Metrics(const Metrics&) = delete;
+
+    void add(MetricCounter counter, std::uint64_t amount = 1) {
+        local().counters[counter].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    void set(MetricGauge gauge, std::int64_t value) {
+        gauges[gauge].store(value, std::memory_order_relaxed);
+    }
+
+    void record(MetricHistogram histogram, std::chrono::nanoseconds duration) {
+        std::uint64_t nanos = static_cast<std::uint64_t>(std::max<std::int64_t>(0, duration.count()));
+        Shard& shard = local();
+        shard.buckets[histogram][bucketIndex((nanos + 999) / 1000)].fetch_add(1, std::memory_order_relaxed);
+        shard.sumNanos[histogram].fetch_add(nanos, std::memory_order_relaxed);
+    }
+
+    // Prometheus text exposition format, version 0.0.4
+    std::string prometheusText() const {
+        std::ostringstream out;
+        int shards = std::min<int>(shardCount.load(std::memory_order_acquire), maxShards);
+        for (int i = 0; i < MetricCounterCount; i++) {
+            std::uint64_t total = 0;
+            for (int s = 0; s < shards; s++) total += this->shards[s].counters[i].load(std::memory_order_relaxed);
+            header(out, counterInfo[i], "counter");
+            out << counterInfo[i].name << " " << total << "\n";
+        }
+        for (int i = 0; i < MetricGaugeCount; i++) {
+            header(out, gaugeInfo[i], "gauge");
+            out << gaugeInfo[i].name << " " << gauges[i].load(std::memory_order_relaxed) << "\n";
+        }
+        for (int i = 0; i < MetricHistogramCount; i++) {
+            header(out, histogramInfo[i], "histogram");
+            std::uint64_t cumulative = 0, sum = 0;
+            for (int b = 0; b < bucketCount; b++) {
+                for (int s = 0; s < shards; s++) cumulative += this->shards[s].buckets[i][b].load(std::memory_order_relaxed);
+                out << histogramInfo[i].name << "_bucket{le=\"" << bucketLimit(b) / 1e6 << "\"} " << cumulative << "\n";
+            }
+            for (int s = 0; s < shards; s++) sum += this->shards[s].sumNanos[i].load(std::memory_order_relaxed);
+            out << histogramInfo[i].name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+            out << histogramInfo[i].name << "_sum " << sum / 1e9 << "\n";
+            out << histogramInfo[i].name << "_count " << cumulative << "\n";
+        }
+        return out.str();
+    }
+
+    // Bucket holding a sample of this many microseconds: the first whose limit is >= it
+    static constexpr int bucketIndex(std::uint64_t micros) {
+        if (micros <= (std::uint64_t(1) << firstOctave)) return 0;
+        micros--;  // Buckets are [lower, limit) over micros - 1, so (lower, limit] over micros
+        int octave = 0;
+        while (micros >> (octave + 1)) octave++;
+        int sub = static_cast<int>((micros >> (octave - 2)) & (subBuckets - 1));
+        int index = 1 + (octave - firstOctave) * subBuckets + sub;
+        return std::min(index, bucketCount - 1);
+    }
+
+    // Largest sample in microseconds counted in bucket
+    static constexpr std::uint64_t bucketLimit(int bucket) {
+        if (bucket == 0) return std::uint64_t(1) << firstOctave;
+        int octave = firstOctave + (bucket - 1) / subBuckets;
+        int sub = (bucket - 1) % subBuckets;
+        return std::uint64_t(subBuckets + sub + 1) << (octave - 2);
+    }
+
+    // Every limit lands in its own bucket and one past it in the next
+    static constexpr bool bucketLimitsInclusive() {
+        for (int b = 0; b + 1 < bucketCount; b++) {
+            if (bucketIndex(bucketLimit(b)) != b || bucketIndex(bucketLimit(b) + 1) != b + 1) return false;
+        }
+        return bucketIndex(bucketLimit(bucketCount - 1)) == bucketCount - 1;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> counters[MetricCounterCount];
+        std::atomic<std::uint64_t> buckets[MetricHistogramCount][bucketCount];
+        std::atomic<std::uint64_t> sumNanos[MetricHistogramCount];
+
+        Shard() {
+            for (auto& counter : counters) counter.store(0, std::memory_order_relaxed);
+            for (auto& histogram : buckets) {
+                for (auto& bucket : histogram) bucket.store(0, std::memory_order_relaxed);
+            }
+            for (auto& sum : sumNanos) sum.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    Shard shards[maxShards];
+    std::atomic<int> shardCount;
+    std::atomic<std::int64_t> gauges[MetricGaugeCount];
+
+    // The calling thread's shard, claimed on first use. One Metrics per process.
+    Shard& local() {
+        thread_local Shard* shard = nullptr;
+        if (!shard) {
+            int index = shardCount.fetch_add(1, std::memory_order_acq_rel);
+            shard = &shards[std::min(index, maxShards - 1)];
+        }
+        return *shard;
+    }
+
+    static void header(std::ostringstream& out, const MetricInfo& info, const char* type) {
+        out << "# HELP " << info.name << " " << info.help << "\n";
+        out << "# TYPE " << info.name << " " << type << "\n";
+    }
+};
+
+static_assert(Metrics::bucketLimitsInclusive(), "a sample equal to a bucket's le must be counted in it");
+
+inline Metrics& metrics() {
+    static Metrics instance;
+    return instance;
+}
+
+// Publishes metrics() from a background thread: rewrites a file every few
+// seconds (for a node exporter's textfile collector) and/or answers any HTTP
+// request on 127.0.0.1:port with the current values. HTTP is POSIX only.
+class MetricsExporter {
+public:
+    MetricsExporter() : listener(-1), running(false) {}
+
+    ~MetricsExporter() {
+        stop();
+    }
+
+    MetricsExporter(const MetricsExporter&) = delete;
+
+    // Either may be empty/0. Returns false if the port can't be opened.
+    bool start(const std::string& filePath, int port, std::chrono::seconds interval = std::chrono::seconds(5)) {
+        file = filePath;
+        if (port > 0 && !listen(port)) return false;
+        if (file.empty() && listener < 0) return true;
+        running = true;
+        worker = std::thread([this, interval] { run(interval); });
+        return true;
+    }
+
+    void stop() {
+        if (running.exchange(false)) worker.join();
+#ifndef _WIN32
+        if (listener >= 0) close(listener);
+#endif
+        listener = -1;
+    }
+
+private:
+    std::string file;
+    int listener;
+    std::atomic<bool> running;
+    std::thread worker;
+
+    bool listen(int port) {
+#ifdef _WIN32
+        std::cerr << "--metrics-port is not supported on Windows; use --metrics-file" << std::endl;
+        (void)port;
+        return false;
+#else
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<std::uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);  // Never reachable from outside the machine
+        if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listener, 4) != 0) {
+            std::cerr << "Failed to listen for metrics on 127.0.0.1:" << port << std::endl;
+            if (listener >= 0) close(listener);
+            listener = -1;
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    void run(std::chrono::seconds interval) {
+        auto nextWrite = std::chrono::steady_clock::now();
+        while (running) {
+            if (!file.empty() && std::chrono::steady_clock::now() >= nextWrite) {
+                writeFile();
+                nextWrite += interval;
+            }
+            if (listener >= 0) {
+                serve(200);
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            }
+        }
+        if (!file.empty()) writeFile();
+    }
+
+    // Written aside and renamed over, so a scraper never reads half a file
+    void writeFile() {
+        std::string temporary = file + ".tmp";
+        std::FILE* out = std::fopen(temporary.c_str(), "w");
+        if (!out) return;
+        std::string text = metrics().prometheusText();
+        std::fwrite(text.data(), 1, text.size(), out);
+        std::fclose(out);
+        // rename() swaps the new file in atomically, so a reader never finds it
+        // missing; on Windows it won't replace an existing file at all
+#ifdef _WIN32
+        std::remove(file.c_str());
+#endif
+        std::rename(temporary.c_str(), file.c_str());
+    }
+
+    void serve(int timeoutMs) {
+#ifndef _WIN32
+        pollfd waiting = {listener, POLLIN, 0};
+        if (poll(&waiting, 1, timeoutMs) <= 0) return;
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) return;
+        char request[1024];
+        pollfd reading = {client, POLLIN, 0};
+        if (poll(&reading, 1, 1000) > 0) {
+            ssize_t ignored = recv(client, request, sizeof(request), 0);  // Whatever the path, the answer is the same
+            (void)ignored;
+        }
+        std::string body = metrics().prometheusText();
+        std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t written = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (written <= 0) break;
+            sent += static_cast<size_t>(written);
+        }
+        close(client);
+#else
+        (void)timeoutMs;
+#endif
+    }
+};
@@ -0,0 +1,37 @@
+//RenderSnapshot.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "AtlasData.h"
+#include "MemoryTracker.h"
+
+// An atlas sprite placed in the world
+struct SpriteProxy {
+    atlas::Sprite sprite;
+    sf::Vector2f position;  // Top-left corner
+    float scale;
+    bool flipped;
+};
+
+struct EnemyProxy {
+    atlas::Sprite sprite;
+    sf::Vector2f position;
+    float scale;
+    float healthFraction;
+};
+
+// Everything the renderer needs from one sim tick. The sim fills one of these
+// and publishes it; the render thread only ever reads published copies.
+// Vectors are cleared rather than freed, so steady-state publishing reuses memory.
+struct RenderSnapshot {
+    unsigned long tick = 0;
+    sf::View view;
+    bool gameOver = false;
+    int wave = 0;        // 1-based
+    int baseHealth = 0;
+    float baseHealthFraction = 0.0f;
+    sf::Vector2f baseBarPosition;
+    TaggedVector<SpriteProxy, RenderMemory> sprites;   // Base and towers, under the enemies
+    TaggedVector<EnemyProxy, RenderMemory> enemies;
+    TaggedVector<SpriteProxy, RenderMemory> critters;  // Over the enemies
+};
@@ -0,0 +1,206 @@
+//Renderer.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include "Arena.h"
+#include "Atlas.h"
+#include "BackgroundLayer.h"
+#include "ChunkedMap.h"
+#include "EnemyRenderer.h"
+#include "GlyphAtlas.h"
+#include "MemoryTracker.h"
+#include "RenderSnapshot.h"
+#include "SpatialGrid.h"
+#include "SpriteBatch.h"
+
+// Turns a RenderSnapshot into draw calls. Lives on the render thread and never
+// touches simulation state: background, base and towers, enemies, critters,
+// then the HUD in screen space. Anything outside the snapshot's view is skipped
+// before it reaches a batch. Assets that stream in after the first frame
+// (critter sprites, the font) are left out until they arrive. Per-frame vertex
+// staging comes from an arena that is reset at the start of every draw().
+class Renderer {
+public:
+    Renderer(const Atlas& atlas, AssetManager& assets, FontHandle font)
+    : atlas(atlas), assets(assets), font(font), map(nullptr), sprites(atlas, frameArena),
+      enemies(atlas, frameArena), critters(atlas, frameArena),
+      hud(hudGlyphs), gameOverText(bannerGlyphs), memoryText(hudGlyphs), frameMemory(RenderMemory), textBaked(false), memoryOverlay(false),
+      framesCounted(0) {}
+
+    // Static layers baked into the cached background, in draw order
+    void addBackgroundLayer(const sf::Drawable& layer) {
+        background.addLayer(layer);
+    }
+
+    // The streamed map is a background layer whose tiles come and go with the view
+    void streamMap(ChunkedMap& chunkedMap) {
+        map = &chunkedMap;
+        background.addLayer(chunkedMap);
+    }
+
+    // Re-bakes the background next frame, e.g. after a layer's assets were reloaded
+    void invalidateBackground() {
+        background.invalidate();
+    }
+
+    // Re-bakes the glyph atlases next frame, after the font was reloaded
+    void invalidateText() {
+        textBaked = false;
+    }
+
+    // Debug overlay under the HUD with live and peak memory per subsystem.
+    // Any thread.
+    void toggleMemoryOverlay() {
+        memoryOverlay = !memoryOverlay;
+    }
+
+    void draw(sf::RenderTarget& target, const RenderSnapshot& snapshot) {
+        assets.beginFrame();
+        frameArena.reset();
+        target.setView(snapshot.view);
+        target.clear();
+        sf::FloatRect area = visibleArea(snapshot.view);
+        if (map && map->update(area)) {
+            background.invalidate();
+        }
+        background.update(snapshot.view, target.getSize());
+        target.draw(background);
+
+        if (snapshot.gameOver) {
+            target.setView(target.getDefaultView());
+            if (bakeText()) target.draw(gameOverText);
+            drawHud(target, snapshot);
+            return;
+        }
+
+        sprites.clear();
+        for (const auto& sprite : snapshot.sprites) {
+            if (isVisible(area, sprite.sprite, sprite.position, sprite.scale)) sprites.add(sprite);
+        }
+        sprites.addRect(snapshot.baseBarPosition, sf::Vector2f(baseBarWidth * snapshot.baseHealthFraction, 10), sf::Color::Green);
+        target.draw(sprites);
+
+        enemies.clear();
+        for (const auto& enemy : snapshot.enemies) {
+            if (isVisible(area, enemy.sprite, enemy.position, enemy.scale)) {
+                enemies.add(enemy.position, enemy.healthFraction, enemy.sprite, enemy.scale);
+            }
+        }
+        enemies.upload();
+        target.draw(enemies);
+
+        critters.clear();
+        for (const auto& critter : snapshot.critters) {
+            if (!isVisible(area, critter.sprite, critter.position, critter.scale)) continue;
+            if (atlas.isReady(critter.sprite)) {
+                critters.add(critter);
+            } else {
+                atlas.texture(critter.sprite);  // On screen: asks for an evicted page back
+            }
+        }
+        target.draw(critters);
+
+        target.setView(target.getDefaultView());
+        drawHud(target, snapshot);
+        frameMemory.set(frameArena.capacity());
+    }
+
+private:
+    static constexpr float baseBarWidth = 120.0f;
+    static constexpr float barMargin = 20.0f;  // Health bars sit just above their sprite
+    static constexpr float hudMargin = 20.0f;
+
+    static bool isVisible(const sf::FloatRect& area, atlas::Sprite sprite, sf::Vector2f position, float scale) {
+        const atlas::Region& region = atlas::regions[sprite];
+        return area.intersects(sf::FloatRect(position.x, position.y - barMargin,
+                                             region.width * scale, region.height * scale + barMargin));
+    }
+
+    static constexpr unsigned int hudSize = 32;
+    static constexpr unsigned int bannerSize = 200;
+
+    // Glyphs are baked (and the static text laid out) once the font is in
+    bool bakeText() {
+        if (textBaked || !assets.isLoaded(font)) return textBaked;
+        const sf::Font& loaded = assets.font(font);
+        if (!hudGlyphs.bake(loaded, hudSize) || !bannerGlyphs.bake(loaded, bannerSize)) return false;
+
+        const char* const labels[] = {"Wave", "Base", "Enemies", "FPS"};
+        const unsigned int digits[] = {2, 4, 3, 3};
+        float valueColumn = hudMargin + hudGlyphs.measure("Enemies ");
+        hud.clear();
+        for (int i = 0; i < 4; i++) {
+            sf::Vector2f line(hudMargin, hudMargin + i * hudGlyphs.lineSpacing());
+            hud.addText(line, labels[i], sf::Color::White);
+            hudFields[i] = hud.addNumber(sf::Vector2f(valueColumn, line.y), digits[i], sf::Color::White);
+        }
+
+        // Memory overlay: one line per tag, live and peak KiB
+        float memoryTop = hudMargin + 5 * hudGlyphs.lineSpacing();
+        float liveColumn = hudMargin + hudGlyphs.measure("render ");
+        float peakColumn = liveColumn + 9 * hudGlyphs.digitAdvance();
+        memoryText.clear();
+        memoryText.addText(sf::Vector2f(liveColumn, memoryTop), "live KiB", sf::Color::Yellow);
+        memoryText.addText(sf::Vector2f(peakColumn, memoryTop), "peak KiB", sf::Color::Yellow);
+        for (int i = 0; i < MemoryTagCount; i++) {
+            float y = memoryTop + (i + 1) * hudGlyphs.lineSpacing();
+            memoryText.addText(sf::Vector2f(hudMargin, y), memoryTagNames[i], sf::Color::Yellow);
+            memoryFields[i][0] = memoryText.addNumber(sf::Vector2f(liveColumn, y), 8, sf::Color::Yellow);
+            memoryFields[i][1] = memoryText.addNumber(sf::Vector2f(peakColumn, y), 8, sf::Color::Yellow);
+        }
+
+        const std::string banner = "Game Over!";
+        gameOverText.clear();
+        gameOverText.addText(sf::Vector2f(950 - bannerGlyphs.measure(banner) / 2, 500 - bannerSize / 2.0f), banner, sf::Color::Red);
+        textBaked = true;
+        return true;
+    }
+
+    void drawHud(sf::RenderTarget& target, const RenderSnapshot& snapshot) {
+        framesCounted++;
+        float elapsed = fpsClock.getElapsedTime().asSeconds();
+        if (elapsed >= 0.5f) {
+            framesPerSecond = static_cast<int>(framesCounted / elapsed + 0.5f);
+            framesCounted = 0;
+            fpsClock.restart();
+        }
+        if (!bakeText()) return;
+
+        hud.setNumber(hudFields[0], snapshot.wave);
+        hud.setNumber(hudFields[1], snapshot.baseHealth);
+        hud.setNumber(hudFields[2], static_cast<int>(snapshot.enemies.size()));
+        hud.setNumber(hudFields[3], framesPerSecond);
+        target.draw(hud);
+
+        if (memoryOverlay) {
+            for (int i = 0; i < MemoryTagCount; i++) {
+                MemoryTag tag = static_cast<MemoryTag>(i);
+                memoryText.setNumber(memoryFields[i][0], static_cast<int>(memoryTracker().live(tag) / 1024));
+                memoryText.setNumber(memoryFields[i][1], static_cast<int>(memoryTracker().peak(tag) / 1024));
+            }
+            target.draw(memoryText);
+        }
+    }
+
+    const Atlas& atlas;
+    AssetManager& assets;  // Only to start each frame; drawing reads it
+    FontHandle font;
+    ChunkedMap* map;
+    BackgroundLayer background;
+    Arena frameArena;  // Declared before the batches that stage into it
+    SpriteBatch sprites;
+    EnemyRenderer enemies;
+    SpriteBatch critters;
+    GlyphAtlas hudGlyphs, bannerGlyphs;
+    TextBatch hud;            // Wave, base health, enemy count, FPS
+    TextBatch gameOverText;
+    TextBatch memoryText;
+    MemoryCharge frameMemory;  // frameArena's blocks
+    size_t hudFields[4];
+    size_t memoryFields[MemoryTagCount][2];  // Live, peak
+    bool textBaked;
+    std::atomic<bool> memoryOverlay;
+    sf::Clock fpsClock;
+    int framesCounted;
+    int framesPerSecond = 0;
+};
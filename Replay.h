@@ -0,0 +1,179 @@
+//Replay.h
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Fixed.h"
+#include "MemoryTracker.h"
+
+// 64-bit FNV-1a over the bytes of each value added. Add fields one at a time,
+// never whole structs, so padding bytes don't leak into the hash, and cast
+// size_t, int and bool to fixed-width types so every platform hashes the same bytes.
+class StateHash {
+public:
+    StateHash() : value(14695981039346656037ull) {}
+
+    template <typename T>
+    void add(const T& field) {
+        static_assert(std::is_trivially_copyable<T>::value, "hash plain values");
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &field, sizeof(T));
+        for (unsigned char byte : bytes) {
+            value = (value ^ byte) * 1099511628211ull;
+        }
+    }
+
+    std::uint64_t get() const {
+        return value;
+    }
+
+private:
+    std::uint64_t value;
+};
+
+// Gameplay state is hashed per subsystem, so a mismatch says where to look
+enum HashedSubsystem {
+    EnemiesHash,
+    TowersHash,
+    BaseHash,
+    WavesHash,
+    HashedSubsystemCount
+};
+
+const char* const hashedSubsystemNames[HashedSubsystemCount] = {"enemies", "towers", "base", "waves"};
+
+struct TickHash {
+    std::uint64_t subsystems[HashedSubsystemCount];
+};
+
+// Replay files are text, one record per line:
+//
+//   gloom-replay 1 <float|fixed>
+//   place <tick> <x> <y>         tower placed before tick ran; Scalar bits in hex
+//   hash <tick> <enemies> <towers> <base> <waves>
+//
+// Scalar bits only mean the same thing to a build with the same Scalar type.
+namespace replay {
+    static_assert(sizeof(Scalar) == sizeof(std::uint32_t), "Scalar is written as 32 bits");
+
+#ifdef GLOOM_FIXED_POINT
+    const char* const scalarName = "fixed";
+#else
+    const char* const scalarName = "float";
+#endif
+
+    inline std::uint32_t bits(Scalar value) {
+        std::uint32_t result;
+        std::memcpy(&result, &value, sizeof(result));
+        return result;
+    }
+
+    inline Scalar fromBits(std::uint32_t value) {
+        Scalar result;
+        std::memcpy(static_cast<void*>(&result), &value, sizeof(result));
+        return result;
+    }
+}
+
+// Writes inputs and hashes as the game runs. Uses stdio only, so recording adds
+// no heap allocations to a tick.
+class ReplayRecorder {
+public:
+    ReplayRecorder() : file(nullptr) {}
+
+    ~ReplayRecorder() {
+        if (file) std::fclose(file);
+    }
+
+    ReplayRecorder(const ReplayRecorder&) = delete;
+
+    bool open(const std::string& path) {
+        file = std::fopen(path.c_str(), "w");
+        if (!file) {
+            std::cerr << "Failed to open replay " << path << " for writing" << std::endl;
+            return false;
+        }
+        std::fprintf(file, "gloom-replay 1 %s\n", replay::scalarName);
+        return true;
+    }
+
+    bool isOpen() const {
+        return file != nullptr;
+    }
+
+    void place(unsigned long tick, SimVector position) {
+        if (file) std::fprintf(file, "place %lu %08x %08x\n", tick, replay::bits(position.x), replay::bits(position.y));
+    }
+
+    void hash(unsigned long tick, const TickHash& hash) {
+        if (!file) return;
+        std::fprintf(file, "hash %lu", tick);
+        for (std::uint64_t subsystem : hash.subsystems) {
+            std::fprintf(file, " %016llx", static_cast<unsigned long long>(subsystem));
+        }
+        std::fputc('\n', file);
+    }
+
+private:
+    std::FILE* file;
+};
+
+// A recording read back for verification
+struct Replay {
+    struct Placement {
+        unsigned long tick;
+        SimVector position;
+    };
+
+    TaggedVector<Placement, ReplayMemory> placements;  // In tick order
+    TaggedVector<unsigned long, ReplayMemory> hashTicks;
+    TaggedVector<TickHash, ReplayMemory> hashes;       // Parallel to hashTicks
+
+    bool load(const std::string& path) {
+        std::ifstream file(path);
+        std::string header, scalar;
+        int version = 0;
+        if (!(file >> header >> version >> scalar) || header != "gloom-replay" || version != 1) {
+            std::cerr << path << " is not a replay" << std::endl;
+            return false;
+        }
+        if (scalar != replay::scalarName) {
+            std::cerr << path << " was recorded with " << scalar << " math; this build uses " << replay::scalarName << std::endl;
+            return false;
+        }
+
+        std::string line;
+        std::getline(file, line);
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string kind;
+            unsigned long tick;
+            if (!(fields >> kind >> tick)) continue;
+            if (kind == "place") {
+                std::uint32_t x, y;
+                if (!(fields >> std::hex >> x >> y)) return malformed(path, line);
+                placements.push_back({tick, SimVector(replay::fromBits(x), replay::fromBits(y))});
+            } else if (kind == "hash") {
+                TickHash hash;
+                for (std::uint64_t& subsystem : hash.subsystems) {
+                    if (!(fields >> std::hex >> subsystem)) return malformed(path, line);
+                }
+                hashTicks.push_back(tick);
+                hashes.push_back(hash);
+            }
+        }
+        return true;
+    }
+
+private:
+    static bool malformed(const std::string& path, const std::string& line) {
+        std::cerr << "Malformed line in " << path << ": " << line << std::endl;
+        return false;
+    }
+};
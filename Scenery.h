@@ -0,0 +1,109 @@
+//Scenery.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <vector>
+#include "Arena.h"
+#include "Atlas.h"
+#include "SpatialGrid.h"
+
+enum SceneryKind {
+    Rock,
+    Tree,
+    FlowerFirst,
+    FlowerSecond,
+    FlowerThird,
+    SceneryKindCount
+};
+
+struct SceneryProp {
+    SceneryKind kind;
+    float x, y;
+    float scale;
+};
+
+// Atlas sprite used for each SceneryKind
+const atlas::Sprite scenerySprites[SceneryKindCount] = {
+    atlas::Rock,
+    atlas::Tree,
+    atlas::FlowerFirst,
+    atlas::FlowerSecond,
+    atlas::FlowerThird
+};
+
+// All scenery props share one atlas page (the packer keeps small sprites together) and
+// are drawn as a single quad array. Props sit in a SpatialGrid so each draw
+// only emits the ones inside the target's current view; the visible list and
+// vertices are built in the drawing thread's scratch arena.
+class SceneryBatch : public sf::Drawable {
+public:
+    SceneryBatch(const Atlas& atlas) : atlas(atlas), lastVisible(0) {}
+
+    void add(const SceneryProp& prop) {
+        grid.insert(props.size(), bounds(prop));
+        props.push_back(prop);
+    }
+
+    // Re-buckets every prop, for when atlas regions changed size
+    void rebuild() {
+        grid.clear();
+        for (size_t i = 0; i < props.size(); i++) {
+            grid.insert(i, bounds(props[i]));
+        }
+    }
+
+    void clear() {
+        props.clear();
+        grid.clear();
+    }
+
+    size_t propCount() const {
+        return props.size();
+    }
+
+    // Props emitted by the most recent draw
+    size_t visibleCount() const {
+        return lastVisible;
+    }
+
+private:
+    const Atlas& atlas;
+    std::vector<SceneryProp> props;
+    mutable SpatialGrid grid;
+    mutable size_t lastVisible;
+
+    static sf::FloatRect bounds(const SceneryProp& prop) {
+        sf::IntRect rect = Atlas::rect(scenerySprites[prop.kind]);
+        return sf::FloatRect(prop.x, prop.y, rect.width * prop.scale, rect.height * prop.scale);
+    }
+
+    static void appendQuad(ArenaVector<sf::Vertex>& vertices, const SceneryProp& prop) {
+        sf::IntRect rect = Atlas::rect(scenerySprites[prop.kind]);
+        float width = rect.width * prop.scale;
+        float height = rect.height * prop.scale;
+        float left = static_cast<float>(rect.left);
+        float top = static_cast<float>(rect.top);
+
+        vertices.emplace_back(sf::Vector2f(prop.x, prop.y), sf::Vector2f(left, top));
+        vertices.emplace_back(sf::Vector2f(prop.x + width, prop.y), sf::Vector2f(left + rect.width, top));
+        vertices.emplace_back(sf::Vector2f(prop.x + width, prop.y + height), sf::Vector2f(left + rect.width, top + rect.height));
+        vertices.emplace_back(sf::Vector2f(prop.x, prop.y + height), sf::Vector2f(left, top + rect.height));
+    }
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
+        ScratchScope scratch;
+        ArenaVector<size_t> visible(scratch.arena);
+        grid.query(visibleArea(target.getView()), visible);
+        std::sort(visible.begin(), visible.end());  // Keep the authored overlap order
+        lastVisible = visible.size();
+        if (visible.empty()) return;
+
+        ArenaVector<sf::Vertex> vertices(scratch.arena);
+        vertices.reserve(visible.size() * 4);
+        for (size_t id : visible) {
+            appendQuad(vertices, props[id]);
+        }
+        states.texture = &atlas.texture(scenerySprites[0]);
+        target.draw(vertices.data(), vertices.size(), sf::Quads, states);
+    }
+};
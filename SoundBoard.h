@@ -0,0 +1,174 @@
+//SoundBoard.h
+#pragma once
+#include <SFML/Audio.hpp>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AssetManager.h"
+#include "MemoryTracker.h"
+
+enum SoundEffect {
+    TowerShot,
+    EnemyDeath,
+    BaseHit,
+    SoundEffectCount
+};
+
+struct SoundEffectInfo {
+    const char* file;         // Optional override in the asset root; synthesised if absent
+    unsigned int maxVoices;   // Never more than this many playing at once
+    int priority;             // Higher steals voices from lower when the pool is full
+    float volume;
+    float minInterval;        // Seconds before the same effect may start again
+};
+
+const SoundEffectInfo soundEffects[SoundEffectCount] = {
+    {"shot.wav", 3, 0, 35.0f, 0.08f},
+    {"enemy_death.wav", 4, 1, 70.0f, 0.0f},
+    {"base_hit.wav", 2, 2, 90.0f, 0.2f}
+};
+
+// Plays sound effects from a fixed pool of voices over buffers decoded once at
+// load. Every request goes through the same gates, so cost stays flat however
+// many towers are firing: repeats inside an effect's minInterval are dropped,
+// an effect at its voice cap restarts its own oldest voice, and when the pool is
+// full a request takes the oldest voice of the lowest lower-priority effect or
+// is dropped.
+class SoundBoard {
+public:
+    static const size_t voiceCount = 16;
+
+    SoundBoard() : playCount(0), sampleMemory(AudioMemory) {
+        for (auto& voice : voices) {
+            voice.effect = SoundEffectCount;
+            voice.started = 0;
+        }
+    }
+
+    // Main thread, before the first play()
+    void load(const AssetManager& assets) {
+        for (int i = 0; i < SoundEffectCount; i++) {
+            std::string bytes;
+            if (assets.readFile(soundEffects[i].file, bytes) && buffers[i].loadFromMemory(bytes.data(), bytes.size())) {
+                continue;
+            }
+            synthesize(static_cast<SoundEffect>(i), buffers[i]);
+        }
+        size_t bytes = 0;
+        for (const auto& buffer : buffers) {
+            bytes += static_cast<size_t>(buffer.getSampleCount()) * sizeof(sf::Int16);
+        }
+        sampleMemory.set(bytes);
+    }
+
+    void play(SoundEffect effect) {
+        const SoundEffectInfo& info = soundEffects[effect];
+        if (sinceLastPlay[effect].getElapsedTime().asSeconds() < info.minInterval) return;
+
+        Voice* free = nullptr;
+        unsigned int playing = 0;
+        for (auto& voice : voices) {
+            if (!isPlaying(voice)) {
+                if (!free) free = &voice;
+            } else if (voice.effect == effect) {
+                playing++;
+            }
+        }
+        Voice* chosen = playing >= info.maxVoices ? oldest(effect) : free ? free : stealable(info.priority);
+        if (!chosen) return;
+
+        chosen->sound.stop();
+        chosen->sound.setBuffer(buffers[effect]);
+        chosen->sound.setVolume(info.volume);
+        chosen->sound.play();
+        chosen->effect = effect;
+        chosen->started = ++playCount;
+        sinceLastPlay[effect].restart();
+    }
+
+    void stopAll() {
+        for (auto& voice : voices) {
+            voice.sound.stop();
+        }
+    }
+
+    size_t playingCount() const {
+        size_t count = 0;
+        for (const auto& voice : voices) {
+            if (isPlaying(voice)) count++;
+        }
+        return count;
+    }
+
+private:
+    struct Voice {
+        sf::Sound sound;
+        SoundEffect effect;
+        unsigned long started;  // Order of play() calls, to find the oldest
+    };
+
+    sf::SoundBuffer buffers[SoundEffectCount];  // Declared before the voices, so it outlives them
+    Voice voices[voiceCount];
+    sf::Clock sinceLastPlay[SoundEffectCount];
+    unsigned long playCount;
+    MemoryCharge sampleMemory;
+
+    static bool isPlaying(const Voice& voice) {
+        return voice.sound.getStatus() == sf::Sound::Playing;
+    }
+
+    Voice* oldest(SoundEffect effect) {
+        Voice* found = nullptr;
+        for (auto& voice : voices) {
+            if (isPlaying(voice) && voice.effect == effect && (!found || voice.started < found->started)) found = &voice;
+        }
+        return found;
+    }
+
+    // Oldest voice of the lowest-priority effect below priority, if any
+    Voice* stealable(int priority) {
+        Voice* found = nullptr;
+        for (auto& voice : voices) {
+            if (!isPlaying(voice)) continue;
+            int voicePriority = soundEffects[voice.effect].priority;
+            if (voicePriority >= priority) continue;
+            if (!found || voicePriority < soundEffects[found->effect].priority ||
+                (voicePriority == soundEffects[found->effect].priority && voice.started < found->started)) {
+                found = &voice;
+            }
+        }
+        return found;
+    }
+
+    // Stand-ins so the game has feedback without any audio files
+    static void synthesize(SoundEffect effect, sf::SoundBuffer& buffer) {
+        const unsigned int sampleRate = 44100;
+        const float pi = 3.14159265f;
+        float duration = effect == TowerShot ? 0.06f : effect == EnemyDeath ? 0.25f : 0.2f;
+        std::vector<sf::Int16> samples(static_cast<size_t>(duration * sampleRate));
+        std::uint32_t noise = 0x12345678u;
+        float phase = 0.0f;
+
+        for (size_t i = 0; i < samples.size(); i++) {
+            float t = static_cast<float>(i) / sampleRate;
+            float envelope = std::exp(-t * (effect == TowerShot ? 60.0f : 14.0f));
+            noise = noise * 1664525u + 1013904223u;
+            float white = static_cast<float>(noise >> 8) / (1u << 24) * 2.0f - 1.0f;
+
+            float value;
+            if (effect == TowerShot) {
+                phase += 2 * pi * 880.0f / sampleRate;
+                value = 0.5f * (std::sin(phase) > 0 ? 1.0f : -1.0f) + 0.5f * white;  // Square plus a click of noise
+            } else if (effect == EnemyDeath) {
+                phase += 2 * pi * (600.0f - 1800.0f * t) / sampleRate;  // Falling pitch
+                value = std::sin(phase);
+            } else {
+                phase += 2 * pi * 90.0f / sampleRate;  // Low thud
+                value = 0.7f * std::sin(phase) + 0.3f * white;
+            }
+            samples[i] = static_cast<sf::Int16>(value * envelope * 20000.0f);
+        }
+        buffer.loadFromSamples(samples.data(), samples.size(), 1, sampleRate);
+    }
+};
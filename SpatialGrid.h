@@ -0,0 +1,123 @@
+//SpatialGrid.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// World-space rectangle a view can see, rotation included
+inline sf::FloatRect visibleArea(const sf::View& view) {
+    return view.getInverseTransform().transformRect(sf::FloatRect(-1, -1, 2, 2));
+}
+
+// Uniform grid over items that never move. Items are inserted once, build()
+// buckets them into cells, and query() returns the ids overlapping a rectangle
+// while only visiting the cells it covers.
+class SpatialGrid {
+public:
+    SpatialGrid(float cellSize = 256.0f) : cellSize(cellSize), columns(0), rows(0), built(false), queryStamp(0) {}
+
+    void insert(size_t id, const sf::FloatRect& bounds) {
+        if (id >= itemBounds.size()) {
+            itemBounds.resize(id + 1);
+            stamps.resize(id + 1, 0);
+        }
+        itemBounds[id] = bounds;
+        ids.push_back(id);
+        built = false;
+    }
+
+    void clear() {
+        itemBounds.clear();
+        stamps.clear();
+        ids.clear();
+        cellStarts.clear();
+        cellItems.clear();
+        built = false;
+    }
+
+    void build() {
+        if (ids.empty()) {
+            built = true;
+            return;
+        }
+        sf::FloatRect first = itemBounds[ids.front()];
+        float left = first.left, top = first.top;
+        float right = first.left + first.width, bottom = first.top + first.height;
+        for (size_t id : ids) {
+            const sf::FloatRect& b = itemBounds[id];
+            left = std::min(left, b.left);
+            top = std::min(top, b.top);
+            right = std::max(right, b.left + b.width);
+            bottom = std::max(bottom, b.top + b.height);
+        }
+        origin = sf::Vector2f(left, top);
+        columns = static_cast<int>((right - left) / cellSize) + 1;
+        rows = static_cast<int>((bottom - top) / cellSize) + 1;
+
+        // Count per cell, prefix-sum into starts, then fill: one flat array for all cells
+        cellStarts.assign(columns * rows + 1, 0);
+        forEachCell(ids, [&](int cell, size_t) { cellStarts[cell + 1]++; });
+        for (size_t i = 1; i < cellStarts.size(); i++) {
+            cellStarts[i] += cellStarts[i - 1];
+        }
+        cellItems.resize(cellStarts.back());
+        std::vector<size_t> fill(cellStarts.begin(), cellStarts.end() - 1);
+        forEachCell(ids, [&](int cell, size_t id) { cellItems[fill[cell]++] = id; });
+        built = true;
+    }
+
+    // Appends the ids of items overlapping area to out (any vector of size_t), each once
+    template <typename Ids>
+    void query(const sf::FloatRect& area, Ids& out) {
+        if (!built) build();
+        if (ids.empty()) return;
+
+        queryStamp++;
+        int x0, y0, x1, y1;
+        cellRange(area, x0, y0, x1, y1);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                int cell = y * columns + x;
+                for (size_t i = cellStarts[cell]; i < cellStarts[cell + 1]; i++) {
+                    size_t id = cellItems[i];
+                    if (stamps[id] != queryStamp && itemBounds[id].intersects(area)) {
+                        stamps[id] = queryStamp;
+                        out.push_back(id);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    float cellSize;
+    sf::Vector2f origin;
+    int columns, rows;
+    bool built;
+    unsigned int queryStamp;  // Marks items already returned by the current query
+    std::vector<sf::FloatRect> itemBounds;
+    std::vector<unsigned int> stamps;
+    std::vector<size_t> ids;
+    std::vector<size_t> cellStarts, cellItems;
+
+    void cellRange(const sf::FloatRect& area, int& x0, int& y0, int& x1, int& y1) const {
+        x0 = std::max(0, static_cast<int>(std::floor((area.left - origin.x) / cellSize)));
+        y0 = std::max(0, static_cast<int>(std::floor((area.top - origin.y) / cellSize)));
+        x1 = std::min(columns - 1, static_cast<int>(std::floor((area.left + area.width - origin.x) / cellSize)));
+        y1 = std::min(rows - 1, static_cast<int>(std::floor((area.top + area.height - origin.y) / cellSize)));
+    }
+
+    template <typename F>
+    void forEachCell(const std::vector<size_t>& items, F visit) const {
+        for (size_t id : items) {
+            int x0, y0, x1, y1;
+            cellRange(itemBounds[id], x0, y0, x1, y1);
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    visit(y * columns + x, id);
+                }
+            }
+        }
+    }
+};
@@ -0,0 +1,57 @@
+//SpriteBatch.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include "Arena.h"
+#include "Atlas.h"
+#include "RenderSnapshot.h"
+
+// Collects atlas sprites and solid rectangles into one quad array drawn in a
+// single call. Everything added is expected to sit on one atlas page, the one
+// of the last sprite added (or the White sprite's for rectangles only). The
+// vertices live in a per-frame arena: clear() starts a fresh array in it, and
+// must be called after every reset of that arena before adding again.
+class SpriteBatch : public sf::Drawable {
+public:
+    SpriteBatch(const Atlas& atlas, Arena& frameArena)
+    : atlas(atlas), arena(frameArena), vertices(frameArena), page(nullptr) {}
+
+    void clear() {
+        vertices = ArenaVector<sf::Vertex>(arena);
+        page = nullptr;
+    }
+
+    void add(const SpriteProxy& proxy) {
+        page = &atlas.texture(proxy.sprite);
+        sf::IntRect rect = Atlas::rect(proxy.sprite);
+        float left = static_cast<float>(rect.left), right = left + rect.width;
+        if (proxy.flipped) std::swap(left, right);
+        appendQuad(proxy.position, sf::Vector2f(rect.width * proxy.scale, rect.height * proxy.scale),
+                   left, right, static_cast<float>(rect.top), static_cast<float>(rect.top + rect.height), sf::Color::White);
+    }
+
+    void addRect(sf::Vector2f position, sf::Vector2f size, sf::Color color) {
+        sf::IntRect rect = Atlas::rect(atlas::White);
+        appendQuad(position, size, static_cast<float>(rect.left), static_cast<float>(rect.left + rect.width),
+                   static_cast<float>(rect.top), static_cast<float>(rect.top + rect.height), color);
+    }
+
+private:
+    const Atlas& atlas;
+    Arena& arena;
+    ArenaVector<sf::Vertex> vertices;
+    const sf::Texture* page;
+
+    void appendQuad(sf::Vector2f position, sf::Vector2f size, float left, float right, float top, float bottom, sf::Color color) {
+        vertices.emplace_back(position, color, sf::Vector2f(left, top));
+        vertices.emplace_back(sf::Vector2f(position.x + size.x, position.y), color, sf::Vector2f(right, top));
+        vertices.emplace_back(position + size, color, sf::Vector2f(right, bottom));
+        vertices.emplace_back(sf::Vector2f(position.x, position.y + size.y), color, sf::Vector2f(left, bottom));
+    }
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
+        if (vertices.empty()) return;
+        states.texture = page ? page : &atlas.texture(atlas::White);
+        target.draw(vertices.data(), vertices.size(), sf::Quads, states);
+    }
+};
@@ -0,0 +1,195 @@
+//StartupBench.cpp
+// Launch-time benchmark: runs the game repeatedly with --startup-report
+// --exit-after-startup and prints the distribution of every startup stage, for
+// cold launches (asset files evicted from the page cache first) and warm ones.
+//
+// Usage: StartupBench <game executable> [--runs N] [--assets <dir>]
+//
+// Cold runs drop the asset directory and the executable from the page cache
+// with posix_fadvise(DONTNEED), which only evicts clean pages nobody has mapped;
+// run as root to also drop the whole cache through /proc/sys/vm/drop_caches.
+// POSIX only.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+struct Samples {
+    std::vector<std::string> order;  // Stages in the order the game reported them
+    std::map<std::string, std::vector<double>> stages;
+
+    void add(const std::string& stage, double milliseconds) {
+        if (!stages.count(stage)) order.push_back(stage);
+        stages[stage].push_back(milliseconds);
+    }
+};
+
+#ifndef _WIN32
+
+void evict(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+void evictDirectory(const std::string& directory) {
+    if (DIR* dir = opendir(directory.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') evict(directory + "/" + entry->d_name);
+        }
+        closedir(dir);
+    }
+}
+
+void dropCaches(const std::string& game, const std::string& assets) {
+    sync();
+    evict(game);
+    evictDirectory(assets);
+    if (geteuid() == 0) {
+        if (std::FILE* drop = std::fopen("/proc/sys/vm/drop_caches", "w")) {
+            std::fputs("3", drop);
+            std::fclose(drop);
+        }
+    }
+}
+
+// Runs the game once and adds its stage times to samples. "exec" is launch to
+// main(), "exit" launch to process exit.
+bool runOnce(const std::string& game, const std::string& assets, Samples& samples) {
+    int output[2];
+    if (pipe(output) != 0) return false;
+
+    auto launched = std::chrono::steady_clock::now();
+    pid_t child = fork();
+    if (child < 0) return false;
+    if (child == 0) {
+        dup2(output[1], STDOUT_FILENO);
+        close(output[0]);
+        close(output[1]);
+        std::vector<const char*> args = {game.c_str(), "--startup-report", "--exit-after-startup"};
+        if (!assets.empty()) {
+            args.push_back("--assets");
+            args.push_back(assets.c_str());
+        }
+        args.push_back(nullptr);
+        execv(game.c_str(), const_cast<char* const*>(args.data()));
+        _exit(127);
+    }
+
+    close(output[1]);
+    std::string text;
+    char buffer[4096];
+    ssize_t length;
+    while ((length = read(output[0], buffer, sizeof(buffer))) > 0) {
+        text.append(buffer, static_cast<size_t>(length));
+    }
+    close(output[0]);
+    int status = 0;
+    waitpid(child, &status, 0);
+    auto exited = std::chrono::steady_clock::now();
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::cerr << game << " failed (status " << status << ")" << std::endl;
+        return false;
+    }
+
+    bool sawStages = false;
+    size_t lineStart = 0;
+    while (lineStart < text.size()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos) lineEnd = text.size();
+        std::string line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        char stage[64];
+        long long mainClock;
+        double milliseconds;
+        if (std::sscanf(line.c_str(), "startup clock %lld", &mainClock) == 1) {
+            auto launchedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(launched.time_since_epoch()).count();
+            samples.add("exec", (mainClock - launchedNs) / 1e6);
+        } else if (std::sscanf(line.c_str(), "startup %63s %lf", stage, &milliseconds) == 2) {
+            samples.add(stage, milliseconds);
+            sawStages = true;
+        }
+    }
+    samples.add("exit", std::chrono::duration<double, std::milli>(exited - launched).count());
+    if (!sawStages) std::cerr << game << " printed no startup report" << std::endl;
+    return sawStages;
+}
+
+#endif
+
+double percentile(std::vector<double> values, double fraction) {
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+void printTable(const char* title, const Samples& samples) {
+    std::printf("\n%s (ms; exec is relative to launch, the rest to main)\n", title);
+    std::printf("  %-16s %9s %9s %9s %9s %9s\n", "stage", "min", "median", "p90", "max", "mean");
+    for (const auto& stage : samples.order) {
+        const std::vector<double>& values = samples.stages.at(stage);
+        double sum = 0.0;
+        for (double value : values) sum += value;
+        std::printf("  %-16s %9.2f %9.2f %9.2f %9.2f %9.2f\n", stage.c_str(), percentile(values, 0.0),
+                    percentile(values, 0.5), percentile(values, 0.9), percentile(values, 1.0), sum / values.size());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: StartupBench <game executable> [--runs N] [--assets <dir>]" << std::endl;
+        return EXIT_FAILURE;
+    }
+#ifdef _WIN32
+    std::cerr << "StartupBench needs fork/exec and posix_fadvise; it only runs on POSIX systems" << std::endl;
+    return EXIT_FAILURE;
+#else
+    std::string game = argv[1];
+    std::string assets;
+    int runs = 10;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--runs") {
+            runs = std::max(1, std::atoi(argv[i + 1]));
+        } else if (option == "--assets") {
+            assets = argv[i + 1];
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::string assetDirectory = assets;
+    if (assetDirectory.empty()) {
+        size_t slash = game.find_last_of('/');
+        assetDirectory = slash == std::string::npos ? "." : game.substr(0, slash);
+    }
+
+    Samples cold, warm;
+    for (int i = 0; i < runs; i++) {
+        dropCaches(game, assetDirectory);
+        if (!runOnce(game, assets, cold)) return EXIT_FAILURE;
+    }
+    Samples warmUp;
+    if (!runOnce(game, assets, warmUp)) return EXIT_FAILURE;  // Fill the cache, unmeasured
+    for (int i = 0; i < runs; i++) {
+        if (!runOnce(game, assets, warm)) return EXIT_FAILURE;
+    }
+
+    std::printf("%d runs each", runs);
+    printTable("Cold page cache", cold);
+    printTable("Warm page cache", warm);
+    return 0;
+#endif
+}
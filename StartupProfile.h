@@ -0,0 +1,63 @@
+//StartupProfile.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Timestamps for the stages of startup, marked from any thread. Each stage is
+// kept the first time it is marked. report() prints one line per stage:
+//
+//   startup <stage> <ms since main> <ms since previous stage>
+//
+// plus a "startup clock" line with the steady clock at main() in nanoseconds,
+// which StartupBench compares with its own launch time to get exec-to-main.
+class StartupProfile {
+public:
+    StartupProfile() : start(std::chrono::steady_clock::now()) {}
+
+    void mark(const std::string& stage) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& mark : marks) {
+            if (mark.stage == stage) return;
+        }
+        marks.push_back({stage, std::chrono::steady_clock::now()});
+    }
+
+    bool has(const std::string& stage) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& mark : marks) {
+            if (mark.stage == stage) return true;
+        }
+        return false;
+    }
+
+    void report(std::FILE* out) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::fprintf(out, "startup clock %lld\n", static_cast<long long>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count()));
+        auto previous = start;
+        for (const auto& mark : marks) {
+            std::fprintf(out, "startup %-16s %9.2f %9.2f\n", mark.stage.c_str(), milliseconds(start, mark.time),
+                         milliseconds(previous, mark.time));
+            previous = mark.time;
+        }
+        std::fflush(out);
+    }
+
+private:
+    struct Mark {
+        std::string stage;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    std::chrono::steady_clock::time_point start;
+    std::vector<Mark> marks;  // In the order they happened
+    mutable std::mutex mutex;
+
+    static double milliseconds(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+};
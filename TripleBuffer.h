@@ -0,0 +1,42 @@
+//TripleBuffer.h
+#pragma once
+#include <atomic>
+
+// Lock-free single-producer/single-consumer handoff of the latest value. The
+// producer always has a buffer to write into and the consumer always has a
+// complete one to read, so neither side ever waits on the other; values the
+// consumer was too slow to pick up are simply skipped.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : back(0), middle(1), front(2) {}
+
+    // Producer side
+    T& writeBuffer() {
+        return buffers[back];
+    }
+
+    void publish() {
+        back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Consumer side. Swaps in the newest published value; false if nothing new.
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & freshBit)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T& readBuffer() const {
+        return buffers[front];
+    }
+
+private:
+    static const int indexMask = 3;
+    static const int freshBit = 4;
+
+    T buffers[3];
+    int back;
+    std::atomic<int> middle;  // Index of the buffer in transit, plus freshBit once published
+    int front;
+};
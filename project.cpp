@@ -1,44 +1,93 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <cmath>
+#include "AllocCheck.h"
+#include "Arena.h"
+#include "AssetManager.h"
+#include "AssetWatcher.h"
+#include "Atlas.h"
 #include "Balloon.h"
-
-class Enemy;
+#include "Camera.h"
+#include "ChunkedMap.h"
+#include "LoadingScreen.h"
+#include "Log.h"
+#include "MemoryTracker.h"
+#include "Metrics.h"
+#include "Animation.h"
+#include "Critters.h"
+#include "Fixed.h"
+#include "Renderer.h"
+#include "Replay.h"
+#include "RenderSnapshot.h"
+#include "Scenery.h"
+#include "SoundBoard.h"
+#include "StartupProfile.h"
+#include "TripleBuffer.h"
+
+struct Enemy;
 class Tower;
 class PlayerBase;
 class WaveManager;
 class PathManager;
 
+enum EnemyKind {
+    FloatingBalloon,
+    WalkingPlant,
+    EnemyKindCount
+};
+
+// Body animation and on-screen scale of each enemy kind
+const AnimationClip enemyClips[EnemyKindCount] = {
+    {{atlas::Balloon, 1}, 0.0f},
+    {atlas::PlantWalkSheet, 0.12f}
+};
+const float enemyScales[EnemyKindCount] = {0.5f, 4.0f};
+
+// On-screen size of an enemy body, from its first frame in the live atlas layout.
+// The Simulation copies it once for collisions, so a hot-reloaded atlas (or a
+// replay against the built-in one) can't change gameplay.
+inline sf::Vector2f enemySize(EnemyKind kind) {
+    sf::IntRect rect = Atlas::rect(Atlas::frame(enemyClips[kind].sheet, 0));
+    return sf::Vector2f(rect.width * enemyScales[kind], rect.height * enemyScales[kind]);
+}
+
 class PathManager {
 public:
-    std::vector<sf::Vector2f> waypoints;
+    TaggedVector<SimVector, SimMemory> waypoints;
 
     PathManager() {
         waypoints = {
-            sf::Vector2f(0, 540),
-            sf::Vector2f(250, 540),
-            sf::Vector2f(250, 300),
-            sf::Vector2f(1750, 300)
+            SimVector(0, 540),
+            SimVector(250, 540),
+            SimVector(250, 300),
+            SimVector(1750, 300)
         };
     }
 
-    sf::Vector2f getStartPoint() const {
+    SimVector getStartPoint() const {
         return waypoints.front();
     }
 
-    bool updatePosition(Enemy& enemy, float deltaTime);
+    bool updatePosition(Enemy& enemy, Scalar deltaTime);
 };
 
 class PlayerBase {
 public:
-    sf::Sprite shape;
+    sf::Sprite shape;  // Geometry only, never drawn and never given a texture
     sf::RectangleShape healthBar;
     int health;
 
-    PlayerBase(const sf::Texture& texture) : health(6000) {
-        shape.setTexture(texture);
+    PlayerBase(const sf::IntRect& textureRect) : health(6000) {
+        shape.setTextureRect(textureRect);
         shape.setPosition(1920 - shape.getGlobalBounds().width, 300 - shape.getGlobalBounds().height + 120);
 
         healthBar.setSize(sf::Vector2f(100, 10));
@@ -47,10 +96,11 @@ public:
     }
 
     void takeDamage(int damage) {
+        bool wasStanding = health > 0;
         health -= damage;
         if (health <= 0) {
             health = 0;
-            std::cout << "Base destroyed!" << std::endl;
+            if (wasStanding) LOG_INFO("Base destroyed!");
         }
         updateHealthBar();
     }
@@ -61,36 +111,31 @@ public:
     }
 };
 
-class Enemy {
-public:
-    sf::Sprite body;
-    sf::RectangleShape healthBar;
+// Simulation state of one enemy, nothing else: its body sprite and health bar
+// are generated from this at snapshot time, so moving an enemy is one vector add
+struct Enemy {
+    SimVector position;  // Top-left of the body
+    Scalar movementSpeed;
+    Scalar attackTimer;
+    std::int32_t health;
+    std::uint32_t animation;  // Instance id in the shared Animator
+    std::uint16_t waypointIndex;
+    std::uint8_t kind;        // EnemyKind
     bool isDead, isAttacking;
-    float movementSpeed;
-    int health;
-    size_t waypointIndex;
-    float attackTimer;
-    PlayerBase* base;
-
-    Enemy(const sf::Texture& texture, PlayerBase* basePtr) 
-    : isDead(true), isAttacking(false), health(1000), base(basePtr), waypointIndex(0), attackTimer(0.0f) {
-        body.setTexture(texture);
-        body.setScale(0.5, 0.5);
-        body.setPosition(-100, 540);
-        healthBar.setSize(sf::Vector2f(40, 5));
-        healthBar.setFillColor(sf::Color::Red);
-        healthBar.setPosition(body.getPosition().x, body.getPosition().y - 10);
-    }
-
-    void activate(sf::Vector2f startPosition, float speed) {
-        body.setPosition(startPosition);
+
+    explicit Enemy(std::uint32_t animationId)
+    : movementSpeed(0), attackTimer(0), health(1000), animation(animationId), waypointIndex(0),
+      kind(FloatingBalloon), isDead(true), isAttacking(false) {}
+
+    void activate(SimVector startPosition, Scalar speed, EnemyKind enemyKind) {
+        position = startPosition;
+        kind = static_cast<std::uint8_t>(enemyKind);
         movementSpeed = speed;
         isDead = false;
         isAttacking = false;
         health = 1000;
         waypointIndex = 0;
-        attackTimer = 0.0f;
-        updateHealthBar();
+        attackTimer = Scalar(0);
     }
 
     void takeDamage(int damage) {
@@ -98,42 +143,38 @@ public:
         if (health <= 0) {
             kill();
         }
-        updateHealthBar();
     }
 
     void startAttacking() {
         if (!isAttacking) {
             isAttacking = true;
-            attackTimer = 0.0f;
+            attackTimer = Scalar(0);
         }
     }
 
-    void updateHealthBar() {
-        float healthRatio = std::max(0.0f, static_cast<float>(health) / 50.0f);
-        healthBar.setSize(sf::Vector2f(40 * healthRatio/10, 5));
-        healthBar.setPosition(body.getPosition().x, body.getPosition().y - 10);
-    }
-
     void kill() {
         isDead = true;
-        body.setPosition(-100, -100);
-        healthBar.setPosition(-100, -100);
     }
 
-    void attack() {
-        if (isAttacking && attackTimer >= 1.0f && base) {
-            base->takeDamage(5);
-            attackTimer = 0.0f;  // Reset the timer after attack
+    void attack(PlayerBase& base) {
+        if (isAttacking && attackTimer >= Scalar(1)) {
+            base.takeDamage(5);
+            attackTimer = Scalar(0);  // Reset the timer after attack
         }
     }
 
-    void updateAttackTimer(float deltaTime) {
+    void updateAttackTimer(Scalar deltaTime) {
         if (isAttacking) {
             attackTimer += deltaTime;
         }
     }
+
+    sf::Rect<Scalar> bounds(SimVector size) const {
+        return sf::Rect<Scalar>(position, size);
+    }
 };
-bool PathManager::updatePosition(Enemy& enemy, float deltaTime) {
+
+bool PathManager::updatePosition(Enemy& enemy, Scalar deltaTime) {
     if (enemy.isDead || enemy.waypointIndex >= waypoints.size()) {
         return true; // Enemy stops moving if it has reached the end or is dead
     }
@@ -143,16 +184,15 @@ bool PathManager::updatePosition(Enemy& enemy, float deltaTime) {
         return false;
     }
 
-    sf::Vector2f& currentTarget = waypoints[enemy.waypointIndex + 1];
-    sf::Vector2f direction = currentTarget - enemy.body.getPosition();
-    float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-    if (distance > 0) {
+    SimVector& currentTarget = waypoints[enemy.waypointIndex + 1];
+    SimVector direction = currentTarget - enemy.position;
+    Scalar distance = length(direction);
+    if (distance > Scalar(0)) {
         direction /= distance;
-        enemy.body.move(direction * enemy.movementSpeed * deltaTime);
-        enemy.healthBar.move(direction * enemy.movementSpeed * deltaTime);
+        enemy.position += direction * enemy.movementSpeed * deltaTime;
     }
 
-    if (distance < 5.0f) {
+    if (distance < Scalar(5)) {
         enemy.waypointIndex++;
     }
     return false;
@@ -160,25 +200,32 @@ bool PathManager::updatePosition(Enemy& enemy, float deltaTime) {
 
 class Tower {
 public:
-    sf::Sprite shape;
-    float attackRange;
+    sf::Sprite shape;  // Geometry only, never drawn and never given a texture
+    SimVector center;  // Where it was placed; shape is only drawn from
+    Scalar attackRange;
 
-    Tower(const sf::Texture& texture) {
-        shape.setTexture(texture);
+    Tower(const sf::IntRect& textureRect) {
+        shape.setTextureRect(textureRect);
         shape.setOrigin(shape.getLocalBounds().width / 2, shape.getLocalBounds().height / 2);
-        attackRange = 200.0f;
+        attackRange = Scalar(200);
+    }
+
+    void setPosition(SimVector position) {
+        center = position;
+        shape.setPosition(toFloat(position));
     }
 
-    bool isInRange(sf::Vector2f enemyPos) const {
-        sf::Vector2f center = shape.getPosition();
-        float distance = std::sqrt(std::pow(center.x - enemyPos.x, 2) + std::pow(center.y - enemyPos.y, 2));
-        return distance <= attackRange;
+    bool isInRange(SimVector enemyPos) const {
+        return withinDistance(center, enemyPos, attackRange);
     }
 
-    void attackEnemy(Enemy& enemy) {
-        if (isInRange(enemy.body.getPosition()) && !enemy.isDead) {
+    // Returns true if it fired
+    bool attackEnemy(Enemy& enemy) {
+        if (isInRange(enemy.position) && !enemy.isDead) {
             enemy.takeDamage(3); // Damage value can be adjusted
+            return true;
         }
+        return false;
     }
 };
 
@@ -186,23 +233,24 @@ class WaveManager {
 public:
     struct Wave {
         int count;
-        float initialInterval;
-        float stagger;
+        Scalar initialInterval;
+        Scalar stagger;
+        EnemyKind kind;
     };
 
-    std::vector<Wave> waves;
+    TaggedVector<Wave, SimMemory> waves;
     size_t currentWave;
-    float waveTimer;
-    float currentInterval;
-    float currentStagger;
+    Scalar waveTimer;
+    Scalar currentInterval;
+    Scalar currentStagger;
     int enemiesSpawnedInWave;
 
     WaveManager() {
-        waves.push_back({3, 0.0f, 0.2f});
-        waves.push_back({5, 3.0f, 0.1f});
-        waves.push_back({8, 5.0f, 0.3f});
+        waves.push_back({3, Scalar(0), toScalar(0.2f), FloatingBalloon});
+        waves.push_back({5, Scalar(3), toScalar(0.1f), FloatingBalloon});
+        waves.push_back({8, Scalar(5), toScalar(0.3f), FloatingBalloon});
         currentWave = 0;
-        waveTimer = 0.0f;
+        waveTimer = Scalar(0);
         currentInterval = waves[0].initialInterval;
         currentStagger = waves[0].stagger;
         enemiesSpawnedInWave = 0;
@@ -212,21 +260,23 @@ public:
         return enemiesSpawnedInWave >= waves[currentWave].count;
     }
 
-    void update(float deltaTime, std::vector<Enemy>& enemies, int& nextEnemyIndex, sf::Texture& enemyTexture, PathManager& pathManager) {
+    void update(Scalar deltaTime, TaggedVector<Enemy, SimMemory>& enemies, int& nextEnemyIndex, Animator& animator, PathManager& pathManager) {
         if (currentWave >= waves.size()) return;
 
         waveTimer += deltaTime;
         if (waveTimer >= currentInterval && !isWaveComplete()) {
             int enemiesToSpawn = (currentWave >= 2) ? 2 : 1;
-            float speed = calculateSpeed(currentWave);  //Speed based on the wave
+            Scalar speed = calculateSpeed(currentWave);  //Speed based on the wave
 
             for (int i = 0; i < enemiesToSpawn && nextEnemyIndex < enemies.size(); i++) {
-                enemies[nextEnemyIndex].activate(pathManager.getStartPoint(), speed);
+                EnemyKind kind = waves[currentWave].kind;
+                enemies[nextEnemyIndex].activate(pathManager.getStartPoint(), speed, kind);
+                animator.play(enemies[nextEnemyIndex].animation, enemyClips[kind]);
                 nextEnemyIndex++;
                 enemiesSpawnedInWave++;
             }
 
-            waveTimer = 0.0f; // Reset the timer
+            waveTimer = Scalar(0); // Reset the timer
             currentInterval = waves[currentWave].initialInterval; // Prepare the interval for the next wave
             currentStagger = waves[currentWave].stagger;
         }
@@ -236,341 +286,677 @@ public:
                 enemiesSpawnedInWave = 0;
                 currentInterval = waves[currentWave].initialInterval;
                 currentStagger = waves[currentWave].stagger;
-                waveTimer = 0.0f; // Reset the timer for new wave
+                waveTimer = Scalar(0); // Reset the timer for new wave
             }
         }
     }
 
-    float calculateSpeed(size_t waveIndex) {
-        return 150.0f + 2.0f * waveIndex; //formula to increase speed with the wave index
+    Scalar calculateSpeed(size_t waveIndex) {
+        return Scalar(150 + 2 * static_cast<int>(waveIndex)); //formula to increase speed with the wave index
     }
 };
 
-int main() {
-    sf::RenderWindow window(sf::VideoMode(1920, 1080), "Tower Defense Game");
-    window.setFramerateLimit(60);
+// Owns all gameplay state and advances it in fixed ticks on the main thread.
+// The render thread never reads it directly, only the snapshots it writes.
+// Sizes come from the atlas layout, not textures, so it runs without a GL context.
+class Simulation {
+public:
+    static const size_t maxTowers = 10;
+
+    PlayerBase base;
+    sf::Rect<Scalar> baseBounds;  // Collision box; the base never moves
+    SimVector enemySizes[EnemyKindCount];  // Collision sizes per kind, fixed at construction
+    sf::IntRect towerRect;                 // Tower footprint, fixed at construction
+    TaggedVector<Enemy, SimMemory> enemies;
+    TaggedVector<Tower, SimMemory> towers;
+    WaveManager waveManager;
+    PathManager pathManager;
+    Animator animator;  // Drives every sprite animation: enemy bodies and ambient critters
+    Critters critters;
+    Arena frameArena;                      // Reset at the start of every tick
+    ArenaVector<SoundEffect> soundEvents;  // Raised by the last tick, for the SoundBoard
+    int nextEnemyIndex;
+    bool gameOver;
+    unsigned long tickCount;
+
+    Simulation()
+    : base(Atlas::rect(atlas::Base)), soundEvents(frameArena), nextEnemyIndex(0), gameOver(false), tickCount(0) {
+        sf::FloatRect baseRect = base.shape.getGlobalBounds();
+        baseBounds = sf::Rect<Scalar>(toSimVector(sf::Vector2f(baseRect.left, baseRect.top)),
+                                      toSimVector(sf::Vector2f(baseRect.width, baseRect.height)));
+        for (int kind = 0; kind < EnemyKindCount; kind++) {
+            enemySizes[kind] = toSimVector(enemySize(static_cast<EnemyKind>(kind)));
+        }
+        towerRect = Atlas::rect(atlas::Tower);
+        for (int i = 0; i < 60; i++) {
+            enemies.emplace_back(static_cast<std::uint32_t>(animator.add(enemyClips[FloatingBalloon])));
+        }
+        towers.reserve(maxTowers);
+
+        // Tumbleweeds and birds; the second of each heads the other way
+        const AnimationClip tumbleweedClip = {atlas::TumbleweedSheet, 0.2f};
+        const AnimationClip birdClip = {atlas::BirdSheet, 0.1f};
+        critters.add({animator.add(tumbleweedClip), sf::Vector2f(1920, 800), -200.0f, -100, 1920 + 100, false});
+        critters.add({animator.add(tumbleweedClip), sf::Vector2f(20, 200), 200.0f, 1920 + 100, -100, false});
+        critters.add({animator.add(birdClip), sf::Vector2f(1920, 50), -200.0f, -135, 1920, false});
+        critters.add({animator.add(birdClip, 1), sf::Vector2f(-135, 700), 200.0f, 1920 + 135, -135, true});
+    }
 
-    bool gameOver = false;
-    sf::Font gameFont;
-    if (!gameFont.loadFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\Jersey25-Regular.ttf")) {
-        std::cerr << "Failed to load font" << std::endl;
-        return EXIT_FAILURE;
+    void placeTower(SimVector position) {
+        if (towers.size() < maxTowers) {
+            Tower newTower(towerRect);
+            newTower.setPosition(position);
+            towers.push_back(newTower);
+        }
     }
 
-    sf::Text gameOverText("Game Over!", gameFont, 200);
-    gameOverText.setFillColor(sf::Color::Red);
-    gameOverText.setPosition(950 - gameOverText.getGlobalBounds().width / 2, 500 - gameOverText.getGlobalBounds().height / 2);
-
-    sf::Texture mapTexture, enemyTexture, towerTexture, baseTexture, tumbleweedTexture, birdTexture, 
-                rockTexture, treeTexture, flowerFirstTexture, flowerSecondTexture, flowerThirdTexture;
-    if (!mapTexture.loadFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\map.png") ||
-        !enemyTexture.loadFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\balloon.png") ||
-        !towerTexture.loadFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\tower.png") ||
-        !baseTexture.loadFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\base.png") || 
-        !tumbleweedTexture.loadFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\tumbleweedspritesheet.png") ||
-        !birdTexture.loadFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\birdtosize.png") ||
-        !rockTexture.loadFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\rock.png") ||
-        !treeTexture.loadFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\tree.png") ||
-        !flowerFirstTexture.loadFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\flowerfirst.png") ||
-        !flowerSecondTexture.loadFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\flowersecond.png") ||
-        !flowerThirdTexture.loadFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\flowerthird.png")) {
-        std::cerr << "Failed to load one or more textures" << std::endl;
-        return EXIT_FAILURE;
+    void tick(float deltaTime) {
+        tickCount++;
+        // Per-tick data lives in the frame arena, so ticks don't touch the heap
+        frameArena.reset();
+        soundEvents = ArenaVector<SoundEffect>(frameArena);
+        if (!gameOver) {
+            int baseHealthBefore = base.health;
+            int spawnedBefore = nextEnemyIndex;
+            bool towerFired = false;
+            Scalar step = toScalar(deltaTime);  // Gameplay state only ever advances in Scalar
+            waveManager.update(step, enemies, nextEnemyIndex, animator, pathManager);
+            metrics().add(EnemiesSpawned, nextEnemyIndex - spawnedBefore);
+            for (auto& enemy : enemies) {
+                if (!enemy.isDead) {
+                    pathManager.updatePosition(enemy, step);
+
+                    if (enemy.isAttacking) {
+                        enemy.updateAttackTimer(step);
+                        enemy.attack(base);
+                    }
+
+                    for (auto& tower : towers) {
+                        if (tower.attackEnemy(enemy)) {
+                            towerFired = true;
+                            metrics().add(TowerShots);
+                            if (enemy.isDead) {
+                                soundEvents.push_back(EnemyDeath);
+                                metrics().add(EnemiesKilled);
+                            }
+                        }
+                    }
+
+                    if (enemy.bounds(enemySizes[enemy.kind]).intersects(baseBounds)) {
+                        base.takeDamage(3);
+                    }
+                }
+            }
+
+            if (towerFired) soundEvents.push_back(TowerShot);
+            if (base.health < baseHealthBefore) {
+                soundEvents.push_back(BaseHit);
+                metrics().add(BaseDamageTaken, baseHealthBefore - base.health);
+            }
+            metrics().set(EnemiesAlive, std::count_if(enemies.begin(), enemies.end(), [](const Enemy& enemy) {
+                return !enemy.isDead;
+            }));
+
+            if (base.health <= 0) {
+                gameOver = true;
+            }
+        }
+
+        // Ambient critters keep moving after game over
+        animator.advance(deltaTime);
+        critters.update(deltaTime);
     }
 
-    sf::Music backgroundMusic;
-    if (!backgroundMusic.openFromFile("C:\\Users\\seren\\Downloads\\GD5\\GD5\\sprites\\GameMusic.wav")) {
-        std::cerr << "Failed to load background music" << std::endl;
-        return EXIT_FAILURE;
+    // Everything that decides how the game plays out, hashed per subsystem.
+    // Animation and critters are cosmetic and left out.
+    void hash(TickHash& out) const {
+        StateHash enemyHash;
+        for (const auto& enemy : enemies) {
+            enemyHash.add(enemy.position.x);
+            enemyHash.add(enemy.position.y);
+            enemyHash.add(enemy.movementSpeed);
+            enemyHash.add(enemy.attackTimer);
+            enemyHash.add(enemy.health);
+            enemyHash.add(enemy.waypointIndex);
+            enemyHash.add(enemy.kind);
+            enemyHash.add(static_cast<std::uint8_t>(enemy.isDead));
+            enemyHash.add(static_cast<std::uint8_t>(enemy.isAttacking));
+        }
+        out.subsystems[EnemiesHash] = enemyHash.get();
+
+        StateHash towerHash;
+        for (const auto& tower : towers) {
+            towerHash.add(tower.center.x);
+            towerHash.add(tower.center.y);
+            towerHash.add(tower.attackRange);
+        }
+        out.subsystems[TowersHash] = towerHash.get();
+
+        StateHash baseHash;
+        baseHash.add(static_cast<std::int32_t>(base.health));
+        baseHash.add(static_cast<std::uint8_t>(gameOver));
+        out.subsystems[BaseHash] = baseHash.get();
+
+        StateHash waveHash;
+        waveHash.add(static_cast<std::uint32_t>(waveManager.currentWave));
+        waveHash.add(waveManager.waveTimer);
+        waveHash.add(waveManager.currentInterval);
+        waveHash.add(static_cast<std::int32_t>(waveManager.enemiesSpawnedInWave));
+        waveHash.add(static_cast<std::int32_t>(nextEnemyIndex));
+        out.subsystems[WavesHash] = waveHash.get();
     }
 
-    backgroundMusic.setLoop(true);  // Set the music to loop
-    backgroundMusic.play();         // Start playing the music
-
-    sf::Sprite mapSprite(mapTexture);
-    PlayerBase base(baseTexture);
-
-    // Environment objects
-    // Environment objects
-    sf::Sprite rock1(rockTexture), rock2(rockTexture),
-        rock3(rockTexture), rock4(rockTexture),
-        rock5(rockTexture), rock6(rockTexture),
-        rock7(rockTexture), rock8(rockTexture),
-        rock9(rockTexture), rock10(rockTexture),
-        rock11(rockTexture), rock12(rockTexture),
-        rock13(rockTexture), rock14(rockTexture);
-
-    rock1.setPosition(1600, 100);
-    rock1.setScale(2.5, 2.5);
-    rock2.setPosition(1100, 30);
-    rock2.setScale(2.5, 2.5);
-    rock3.setPosition(700, 120);
-    rock3.setScale(2.5, 2.5);
-    rock4.setPosition(300, 60);
-    rock4.setScale(2.5, 2.5);
-    rock5.setPosition(70, 400);
-    rock5.setScale(2.5, 2.5);
-    rock6.setPosition(600, 600);
-    rock6.setScale(2.5, 2.5);
-    rock7.setPosition(70, 900);
-    rock7.setScale(2.5, 2.5);
-    rock8.setPosition(400, 850);
-    rock8.setScale(2.5, 2.5);
-    rock9.setPosition(700, 500);
-    rock9.setScale(2.5, 2.5);
-    rock10.setPosition(850, 680);
-    rock10.setScale(2.5, 2.5);
-    rock11.setPosition(900, 1000);
-    rock11.setScale(2.5, 2.5);
-    rock12.setPosition(1110, 1200);
-    rock12.setScale(2.5, 2.5);
-    rock13.setPosition(1400, 600);
-    rock13.setScale(2.5, 2.5);
-    rock14.setPosition(1600, 700);
-    rock14.setScale(2.5, 2.5);
-
-    sf::Sprite tree1(treeTexture), tree2(treeTexture), tree3(treeTexture), tree4(treeTexture), tree5(treeTexture), tree6(treeTexture),
-        tree7(treeTexture), tree8(treeTexture), tree9(treeTexture), tree10(treeTexture);
-
-    tree1.setPosition(1400, 700);
-    tree1.setScale(3.0, 3.0);
-    tree2.setPosition(1550, 60);
-    tree2.setScale(3.0, 3.0);
-    tree3.setPosition(410, 12);
-    tree3.setScale(3.0, 3.0);
-    tree4.setPosition(30, 635);
-    tree4.setScale(3.0, 3.0);
-    tree5.setPosition(1080, 500);
-    tree5.setScale(3.0, 3.0);
-    tree6.setPosition(700, 450);
-    tree6.setScale(3.0, 3.0);
-    tree7.setPosition(900, 800);
-    tree7.setScale(3.0, 3.0);
-    tree8.setPosition(475, 750);
-    tree8.setScale(3.0, 3.0);
-    tree9.setPosition(820, 68);
-    tree9.setScale(3.0, 3.0);
-    tree10.setPosition(1600, 400);
-    tree10.setScale(3.0, 3.0);
-
-    // first flower
-    sf::Sprite flowerFirst1(flowerFirstTexture), flowerFirst2(flowerFirstTexture), flowerFirst3(flowerFirstTexture),
-        flowerFirst4(flowerFirstTexture), flowerFirst5(flowerFirstTexture), flowerFirst6(flowerFirstTexture),
-        flowerFirst7(flowerFirstTexture), flowerFirst8(flowerFirstTexture), flowerFirst9(flowerFirstTexture);
-
-    flowerFirst1.setPosition(1700, 900);
-    flowerFirst1.setScale(2.0, 2.0);
-    flowerFirst2.setPosition(1750, 650);
-    flowerFirst2.setScale(2.0, 2.0);
-    flowerFirst3.setPosition(1300, 150);
-    flowerFirst3.setScale(2.0, 2.0);
-    flowerFirst4.setPosition(930, 600);
-    flowerFirst4.setScale(2.0, 2.0);
-    flowerFirst5.setPosition(1100, 800);
-    flowerFirst5.setScale(2.0, 2.0);
-    flowerFirst6.setPosition(475, 525);
-    flowerFirst6.setScale(2.0, 2.0);
-    flowerFirst7.setPosition(300, 900);
-    flowerFirst7.setScale(2.0, 2.0);
-    flowerFirst8.setPosition(60, 300);
-    flowerFirst8.setScale(2.0, 2.0);
-    flowerFirst9.setPosition(100, 10);
-    flowerFirst9.setScale(2.0, 2.0);
-
-    sf::Sprite flowerSecond1(flowerSecondTexture), flowerSecond2(flowerSecondTexture), flowerSecond3(flowerSecondTexture), flowerSecond4(flowerSecondTexture),
-        flowerSecond5(flowerSecondTexture), flowerSecond6(flowerSecondTexture), flowerSecond7(flowerSecondTexture), flowerSecond8(flowerSecondTexture);
-
-    flowerSecond1.setPosition(450, 650); // good position, on bottom
-    flowerSecond1.setScale(3.0, 3.0);
-    flowerSecond2.setPosition(1000, 475); // good position, on bottom
-    flowerSecond2.setScale(3.0, 3.0);
-
-    sf::Sprite flowerThird1(flowerThirdTexture), flowerThird2(flowerThirdTexture), flowerThird3(flowerThirdTexture), flowerThird4(flowerThirdTexture),
-        flowerThird5(flowerThirdTexture), flowerThird6(flowerThirdTexture), flowerThird7(flowerThirdTexture), flowerThird8(flowerThirdTexture);
-
-    flowerThird1.setPosition(300, 750);
-    flowerThird1.setScale(2.5, 2.5);
-    flowerThird2.setPosition(650, 50);
-    flowerThird2.setScale(2.5, 2.5);
-    flowerThird3.setPosition(750, 700);
-    flowerThird3.setScale(2.5, 2.5);
-    flowerThird4.setPosition(1200, 800);
-    flowerThird4.setScale(2.5, 2.5);
-    flowerThird5.setPosition(1400, 500);
-    flowerThird5.setScale(2.5, 2.5);
-    flowerThird6.setPosition(1400, 50);
-    flowerThird6.setScale(2.5, 2.5);
-    flowerThird7.setPosition(1100, 150);
-    flowerThird7.setScale(2.5, 2.5);
-    flowerThird8.setPosition(150, 120);
-    flowerThird8.setScale(2.5, 2.5);
-
-    // Add all sprites to a vector for easy management
-    std::vector<sf::Sprite> staticObjects{
-        rock1, rock2, rock3, rock4, rock5, rock6, rock7, rock8, rock9, rock10, rock11, rock12, rock13, rock14,
-        tree1, tree2, tree3, tree4, tree5, tree6, tree7, tree8, tree9, tree10,
-        
-        flowerFirst1, flowerFirst2, flowerFirst3, flowerFirst4, flowerFirst5, flowerFirst6, flowerFirst7, flowerFirst8, flowerFirst9,
-
-        flowerSecond1, flowerSecond2, flowerSecond3, flowerSecond4, flowerSecond5, flowerSecond6, flowerSecond7, flowerSecond8,
-
-        flowerThird1, flowerThird2, flowerThird3, flowerThird4, flowerThird5, flowerThird6, flowerThird7, flowerThird8
-    };
+    void writeSnapshot(RenderSnapshot& snapshot, const sf::View& view) const {
+        snapshot.tick = tickCount;
+        snapshot.view = view;
+        snapshot.gameOver = gameOver;
+        snapshot.wave = static_cast<int>(std::min(waveManager.currentWave + 1, waveManager.waves.size()));
+        snapshot.baseHealth = base.health;
+        snapshot.baseHealthFraction = base.health / 6000.0f;
+        snapshot.baseBarPosition = base.healthBar.getPosition();
+
+        snapshot.sprites.clear();
+        snapshot.sprites.push_back({atlas::Base, base.shape.getPosition(), 1.0f, false});
+        for (const auto& tower : towers) {
+            snapshot.sprites.push_back({atlas::Tower, tower.shape.getPosition() - tower.shape.getOrigin(), 1.0f, false});
+        }
 
-    std::vector<Enemy> enemies;
-    for (int i = 0; i < 60; i++) {
-        enemies.emplace_back(enemyTexture, &base);
+        snapshot.enemies.clear();
+        for (const auto& enemy : enemies) {
+            if (!enemy.isDead) {
+                snapshot.enemies.push_back({animator.sprite(enemy.animation), toFloat(enemy.position),
+                                            enemyScales[enemy.kind], enemy.health / 1000.0f});
+            }
+        }
+
+        snapshot.critters.clear();
+        for (const auto& critter : critters.all()) {
+            atlas::Sprite sprite = animator.sprite(critter.animation);
+            sf::Vector2f position = critter.position;
+            if (critter.flipped) position.x -= atlas::regions[sprite].width;
+            snapshot.critters.push_back({sprite, position, 1.0f, critter.flipped});
+        }
     }
+};
 
-    std::vector<Tower> towers;
-    int maxTowers = 10;
+static bool hasFlag(int argc, char* argv[], const char* flag) {
+    return std::find(argv + 1, argv + argc, std::string(flag)) != argv + argc;
+}
 
-// Tumbleweed and bird animations setup
-sf::Sprite tumbleweedSprite(tumbleweedTexture), tumbleweedSprite2(tumbleweedTexture);
-sf::Sprite birdSprite(birdTexture), birdSprite2(birdTexture);
+// The argument after flag, or nullptr
+static const char* flagValue(int argc, char* argv[], const char* flag) {
+    char** found = std::find(argv + 1, argv + argc, std::string(flag));
+    return found + 1 < argv + argc ? *(found + 1) : nullptr;
+}
 
-tumbleweedSprite.setTextureRect(sf::IntRect(0, 0, 100, 100));
-tumbleweedSprite2.setTextureRect(sf::IntRect(0, 0, 100, 100));
-birdSprite.setTextureRect(sf::IntRect(0, 0, 135, 92));
-birdSprite2.setTextureRect(sf::IntRect(135, 0, 135, 92));
+// --alloc-check <ticks>: runs the simulation headless (no window, GL context or
+// assets), warms it up with a full set of towers, then fails if any of the next
+// ticks allocates
+static int runAllocationCheck(int ticks) {
+#ifndef GLOOM_ALLOC_CHECK
+    (void)ticks;
+    std::cerr << "--alloc-check needs a build configured with -DGLOOM_ALLOC_CHECK=ON" << std::endl;
+    return EXIT_FAILURE;
+#else
+    Simulation simulation;
+    for (size_t i = 0; i < Simulation::maxTowers; i++) {
+        simulation.placeTower(SimVector(Scalar(400 + 130 * static_cast<int>(i)), Scalar(380)));  // Along the top of the path
+    }
 
-// Flip the second tumbleweed and bird to face the opposite direction
-tumbleweedSprite2.setScale(1.0f, 1.0f);  // Flip horizontally
-birdSprite2.setScale(-1.0f, 1.0f);        // Flip horizontally
+    const float tickTime = 1.0f / 60.0f;
+    const int warmUpTicks = 120;  // Arenas grow to size and the first wave spawns
+    for (int i = 0; i < warmUpTicks; i++) {
+        simulation.tick(tickTime);
+    }
 
-float tumbleweedSpeed = -200.0f, tumbleweedSpeed2 = 200.0f;
-float birdSpeed = -200.0f, birdSpeed2 = 200.0f;
+    allocCheck::arm();
+    for (int i = 0; i < ticks; i++) {
+        simulation.tick(tickTime);
+    }
+    size_t allocations = allocCheck::disarm();
 
-sf::Vector2f tumbleweedPosition(1920, 800), tumbleweedPosition2(20, 200);
-sf::Vector2f birdPosition(1920, 50), birdPosition2(-135, 700); 
+    std::cout << ticks << " ticks after " << warmUpTicks << " warm-up: " << allocations << " allocations" << std::endl;
+    return allocations == 0 ? 0 : EXIT_FAILURE;
+#endif
+}
 
-float elapsedTime = 0.0f, birdAnimationTime = 0.0f;
-const float frameSwitchTime = 0.2f, birdFrameSwitchTime = 0.1f;
-int frameIndex = 0, birdFrameIndex = 0;
+// --replay <file>: reruns a recording headless (no window, GL context or
+// assets), applying its inputs at the ticks they happened, and checks every
+// recorded hash. Reports the first tick whose state differs and which
+// subsystems differ.
+static int runReplay(const char* path) {
+    Replay recording;
+    if (!recording.load(path)) return EXIT_FAILURE;
+
+    Simulation simulation;
+    const float tickTime = 1.0f / 60.0f;
+    size_t nextPlacement = 0;
+    for (size_t i = 0; i < recording.hashes.size(); i++) {
+        while (simulation.tickCount < recording.hashTicks[i]) {
+            while (nextPlacement < recording.placements.size() &&
+                   recording.placements[nextPlacement].tick <= simulation.tickCount) {
+                simulation.placeTower(recording.placements[nextPlacement++].position);
+            }
+            simulation.tick(tickTime);
+        }
 
-    WaveManager waveManager;
-    PathManager pathManager;
+        TickHash hash;
+        simulation.hash(hash);
+        const TickHash& expected = recording.hashes[i];
+        if (std::equal(std::begin(hash.subsystems), std::end(hash.subsystems), std::begin(expected.subsystems))) continue;
 
-    int nextEnemyIndex = 0;
+        std::cerr << "Replay diverged at tick " << simulation.tickCount << " in:";
+        for (int subsystem = 0; subsystem < HashedSubsystemCount; subsystem++) {
+            if (hash.subsystems[subsystem] != expected.subsystems[subsystem]) std::cerr << " " << hashedSubsystemNames[subsystem];
+        }
+        std::cerr << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Replay matched " << recording.hashes.size() << " ticks" << std::endl;
+    return 0;
+}
 
-    sf::Clock gameClock;
-    float deltaTime;
+// --eviction-check <frames>: loads the atlas under a one-byte texture budget and
+// runs frames frames that draw both pages while the main loop polls and trims
+// several times per frame, then frames that draw only the core page while
+// still asking whether the ambient page is ready, as the game does. Fails if
+// the ambient page is evicted while drawn, stays resident once it isn't, or
+// doesn't load again once it is drawn. Then streams the map under the same
+// budget and fails if a tile outside the view stays resident. Needs a GL
+// context but no window.
+static int runEvictionCheck(int argc, char* argv[], int frames) {
+    sf::Context context;
+    AssetManager assets(AssetManager::findRoot(argc, argv));
+    Atlas spriteAtlas(assets);
+    const atlas::Sprite cold = Atlas::frame(atlas::TumbleweedSheet, 0);
+    if (atlas::regions[cold].page == atlas::regions[atlas::White].page) {
+        std::cerr << "Eviction check needs the critters on a deferred page" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!assets.loadAll()) return EXIT_FAILURE;
+
+    assets.setTextureBudget(1);
+    for (int i = 0; i < frames; i++) {
+        assets.beginFrame();
+        spriteAtlas.texture(atlas::White);
+        spriteAtlas.texture(cold);
+        for (int polls = 0; polls < 4; polls++) {  // A main loop outrunning the render thread
+            assets.poll();
+            assets.trimTextures();
+        }
+    }
+    if (!spriteAtlas.isReady(cold)) {
+        std::cerr << "Ambient page was evicted while drawn every frame" << std::endl;
+        return EXIT_FAILURE;
+    }
 
-    while (window.isOpen()) {
+    for (int i = 0; i < frames; i++) {
+        assets.beginFrame();
+        spriteAtlas.texture(atlas::White);  // Drawn every frame
+        spriteAtlas.isReady(cold);          // Polled, never drawn
+        assets.poll();
+        assets.trimTextures();
+    }
+    if (!spriteAtlas.isReady(atlas::White)) {
+        std::cerr << "Core page was evicted" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (spriteAtlas.isReady(cold)) {
+        std::cerr << "Ambient page still resident after " << frames << " frames without a draw" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    spriteAtlas.texture(cold);  // Drawn again
+    for (int waited = 0; !spriteAtlas.isReady(cold) && waited < 2000; waited++) {
+        if (assets.poll() == 0) sf::sleep(sf::milliseconds(1));
+    }
+    if (!spriteAtlas.isReady(cold)) {
+        std::cerr << "Ambient page did not reload after being drawn" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Ambient page evicted after " << frames << " frames and reloaded when drawn" << std::endl;
+
+    ChunkedMap map;
+    if (!map.load(assets, "map.chunks")) {
+        std::cerr << "Failed to load map.chunks" << std::endl;
+        return EXIT_FAILURE;
+    }
+    sf::Vector2f corner = map.worldSize() - sf::Vector2f(1.0f, 1.0f);
+    const sf::FloatRect views[] = {sf::FloatRect(0.0f, 0.0f, 1.0f, 1.0f), sf::FloatRect(corner.x, corner.y, 1.0f, 1.0f)};
+    for (const sf::FloatRect& view : views) {  // One tile in view, then the opposite corner's
+        for (int waited = 0; waited < 2000; waited++) {
+            if (map.update(view) && map.residentCount() > 0) break;  // The tile in view arrived
+            sf::sleep(sf::milliseconds(1));
+        }
+        if (map.residentCount() != 1) {
+            std::cerr << map.residentCount() << " map tiles resident over budget, expected only the one in view" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::cout << "Map kept only the tile in view over budget" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // --startup-report prints when each startup stage finished once everything
+    // has loaded; --exit-after-startup then quits (see StartupBench). Stages are
+    // timed from here, so this stays the first statement.
+    StartupProfile startup;
+
+    // Starts the log writer up front, so the first message logged in a tick
+    // doesn't pay for it. --log-level debug|info|warning|error
+    LogLevel logLevel = LogLevel::Info;
+    if (const char* level = flagValue(argc, argv, "--log-level")) {
+        if (!parseLogLevel(level, logLevel)) std::cerr << "Unknown log level " << level << std::endl;
+    }
+    logger().setLevel(logLevel);
+
+    // --memory-report prints live and peak memory per subsystem on the way out,
+    // however the run ends (F3 shows it in game). Every return goes through finish.
+    bool reportMemory = hasFlag(argc, argv, "--memory-report");
+    auto finish = [&](int status) {
+        if (reportMemory) memoryTracker().report(stdout);
+        return status;
+    };
+
+    // --metrics-file <path> rewrites Prometheus text there every 5 s;
+    // --metrics-port <port> serves it on 127.0.0.1
+    MetricsExporter metricsExporter;
+    const char* metricsFile = flagValue(argc, argv, "--metrics-file");
+    const char* metricsPort = flagValue(argc, argv, "--metrics-port");
+    if (!metricsExporter.start(metricsFile ? metricsFile : "", metricsPort ? std::atoi(metricsPort) : 0)) {
+        return finish(EXIT_FAILURE);
+    }
+
+    if (const char* ticks = flagValue(argc, argv, "--alloc-check")) {
+        return finish(runAllocationCheck(std::max(1, std::atoi(ticks))));
+    }
+    if (const char* replayFile = flagValue(argc, argv, "--replay")) {
+        return finish(runReplay(replayFile));
+    }
+    if (const char* frames = flagValue(argc, argv, "--eviction-check")) {
+        return finish(runEvictionCheck(argc, argv, std::max(2, std::atoi(frames))));
+    }
+
+    startup.mark("telemetry");  // Log writer and metrics exporter running
+    bool reportStartup = hasFlag(argc, argv, "--startup-report");
+    bool exitAfterStartup = hasFlag(argc, argv, "--exit-after-startup");
+
+    sf::RenderWindow window(sf::VideoMode(1920, 1080), "Tower Defense Game");
+    window.setFramerateLimit(60);
+    startup.mark("window");
+
+    // The render thread starts on a loading screen right away and switches to
+    // the game once its renderer is published below
+    LoadingScreen loadingScreen;
+    std::atomic<Renderer*> gameRenderer(nullptr);
+    TripleBuffer<RenderSnapshot> snapshots;
+
+    // Held while a frame is drawn; hot reload takes it to swap assets safely
+    std::mutex frameLock;
+
+    std::atomic<bool> rendering(true);
+    window.setActive(false);
+    std::thread renderThread([&] {
+        window.setActive(true);
+        auto lastPresent = std::chrono::steady_clock::now();
+        while (rendering) {
+            bool drewGame = false;
+            {
+                std::lock_guard<std::mutex> lock(frameLock);
+                if (Renderer* renderer = gameRenderer.load(std::memory_order_acquire)) {
+                    snapshots.acquire();
+                    renderer->draw(window, snapshots.readBuffer());
+                    drewGame = true;
+                } else {
+                    loadingScreen.draw(window);
+                }
+            }
+            window.display();
+            auto presented = std::chrono::steady_clock::now();
+            metrics().record(FrameTime, presented - lastPresent);
+            lastPresent = presented;
+            startup.mark(drewGame ? "first-frame" : "loading-screen");
+        }
+        window.setActive(false);
+    });
+    auto stopRendering = [&] {
+        rendering = false;
+        renderThread.join();
+    };
+
+    // Asset paths are relative to one root (--assets <dir> or $GLOOM_ASSET_ROOT).
+    // Every sprite comes from the atlas packed at build time; the map is
+    // streamed in tiles around the camera. Only the core atlas page holds up the
+    // first game frame: critters, the font and the music load in the background.
+    AssetManager assets(AssetManager::findRoot(argc, argv));
+    // --texture-budget <MiB> bounds asset textures and map tiles together: past
+    // it the map drops tiles outside the view and the least recently drawn
+    // deferred textures are unloaded
+    const char* textureBudget = flagValue(argc, argv, "--texture-budget");
+    if (textureBudget) assets.setTextureBudget(static_cast<size_t>(std::max(0, std::atoi(textureBudget))) * 1024 * 1024);
+    Atlas spriteAtlas(assets);
+    FontHandle gameFont = assets.requestFont("Jersey25-Regular.ttf", LoadPriority::Deferred);
+    DataHandle musicData = assets.requestData("GameMusic.wav", LoadPriority::Deferred);
+    assets.startLoading();
+    startup.mark("assets-queued");
+
+    // Events must be handled on the thread that created the window, loading or not
+    while (assets.pending(LoadPriority::Critical) > 0) {
         sf::Event event;
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed) {
+                stopRendering();
                 window.close();
-            } else if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left && towers.size() < maxTowers) {
-                    sf::Vector2f mousePos = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
-                    Tower newTower(towerTexture);
-                    newTower.shape.setPosition(mousePos);
-                    towers.push_back(newTower);
-                }
+                return finish(0);
             }
         }
-        
-        deltaTime = gameClock.restart().asSeconds();
+        if (assets.poll() == 0) sf::sleep(sf::milliseconds(1));
+        loadingScreen.setProgress(assets.progress());
+    }
 
-        if (!gameOver) {
-            waveManager.update(deltaTime, enemies, nextEnemyIndex, enemyTexture, pathManager);
-            for (auto& enemy : enemies) {
-                if (!enemy.isDead) {
-                    pathManager.updatePosition(enemy, deltaTime);
+    startup.mark("atlas");
 
-                    if (enemy.isAttacking) {
-                        enemy.updateAttackTimer(deltaTime);
-                        enemy.attack();
-                    }
+    ChunkedMap map;
+    if (assets.criticalFailed() || !map.load(assets, "map.chunks")) {
+        std::cerr << "Failed to load one or more assets from " << assets.root() << std::endl;
+        stopRendering();
+        return finish(EXIT_FAILURE);
+    }
+    startup.mark("map");
 
-                    for (auto& tower : towers) {
-                        tower.attackEnemy(enemy);
-                    }
+    sf::Music backgroundMusic;
 
-                    if (enemy.body.getGlobalBounds().intersects(base.shape.getGlobalBounds())) {
-                        base.takeDamage(3);
-                    }
-                }
-            }
+    // --record <file> writes every input and the state hash after each tick, for --replay
+    ReplayRecorder recorder;
+    if (const char* recordFile = flagValue(argc, argv, "--record")) {
+        if (!recorder.open(recordFile)) {
+            stopRendering();
+            return finish(EXIT_FAILURE);
+        }
+    }
 
-            if (base.health <= 0) {
-                gameOver = true;
-                backgroundMusic.stop();  // Optional: Stop music on game over
+    bool musicStarted = false;
+    bool startupReported = false;
+    SoundBoard sounds;
+    sounds.load(assets);
+    startup.mark("sounds");
+
+    // Environment objects, batched into a single draw call
+    SceneryBatch scenery(spriteAtlas);
+    const SceneryProp sceneryProps[] = {
+        {Rock, 1600, 100, 2.5f}, {Rock, 1100, 30, 2.5f}, {Rock, 700, 120, 2.5f}, {Rock, 300, 60, 2.5f},
+        {Rock, 70, 400, 2.5f}, {Rock, 600, 600, 2.5f}, {Rock, 70, 900, 2.5f}, {Rock, 400, 850, 2.5f},
+        {Rock, 700, 500, 2.5f}, {Rock, 850, 680, 2.5f}, {Rock, 900, 1000, 2.5f}, {Rock, 1110, 1200, 2.5f},
+        {Rock, 1400, 600, 2.5f}, {Rock, 1600, 700, 2.5f},
+
+        {Tree, 1400, 700, 3.0f}, {Tree, 1550, 60, 3.0f}, {Tree, 410, 12, 3.0f}, {Tree, 30, 635, 3.0f},
+        {Tree, 1080, 500, 3.0f}, {Tree, 700, 450, 3.0f}, {Tree, 900, 800, 3.0f}, {Tree, 475, 750, 3.0f},
+        {Tree, 820, 68, 3.0f}, {Tree, 1600, 400, 3.0f},
+
+        {FlowerFirst, 1700, 900, 2.0f}, {FlowerFirst, 1750, 650, 2.0f}, {FlowerFirst, 1300, 150, 2.0f},
+        {FlowerFirst, 930, 600, 2.0f}, {FlowerFirst, 1100, 800, 2.0f}, {FlowerFirst, 475, 525, 2.0f},
+        {FlowerFirst, 300, 900, 2.0f}, {FlowerFirst, 60, 300, 2.0f}, {FlowerFirst, 100, 10, 2.0f},
+
+        {FlowerSecond, 450, 650, 3.0f}, // good position, on bottom
+        {FlowerSecond, 1000, 475, 3.0f}, // good position, on bottom
+        // never placed, so these sit at the origin
+        {FlowerSecond, 0, 0, 1.0f}, {FlowerSecond, 0, 0, 1.0f}, {FlowerSecond, 0, 0, 1.0f},
+        {FlowerSecond, 0, 0, 1.0f}, {FlowerSecond, 0, 0, 1.0f}, {FlowerSecond, 0, 0, 1.0f},
+
+        {FlowerThird, 300, 750, 2.5f}, {FlowerThird, 650, 50, 2.5f}, {FlowerThird, 750, 700, 2.5f},
+        {FlowerThird, 1200, 800, 2.5f}, {FlowerThird, 1400, 500, 2.5f}, {FlowerThird, 1400, 50, 2.5f},
+        {FlowerThird, 1100, 150, 2.5f}, {FlowerThird, 150, 120, 2.5f}
+    };
+    for (const auto& prop : sceneryProps) {
+        scenery.add(prop);
+    }
+    startup.mark("scenery");
+
+    Renderer renderer(spriteAtlas, assets, gameFont);
+    renderer.streamMap(map);
+    renderer.addBackgroundLayer(scenery);
+
+    Simulation simulation;
+    Camera camera(window.getDefaultView().getSize(), map.worldSize());
+
+    // --hot-reload: watch the asset root and swap rewritten files in while playing
+    // (e.g. after `cmake --build . --target assets`)
+    AssetWatcher watcher;
+    if (hasFlag(argc, argv, "--hot-reload") && !watcher.watch(assets.root())) {
+        std::cerr << "Failed to watch " << assets.root() << " for changes" << std::endl;
+    }
+    auto reloadAsset = [&](const std::string& file) {
+        if (file == "atlas.regions") {
+            if (!spriteAtlas.reloadRegions(file)) return false;
+            scenery.rebuild();
+            return true;
+        }
+        if (map.reload(assets, file)) {
+            camera.setWorldSize(map.worldSize());
+            return true;
+        }
+        if (file == "GameMusic.wav" && musicStarted) {
+            backgroundMusic.stop();  // It streams from the bytes being replaced
+            bool reloaded = assets.reload(file);
+            if (backgroundMusic.openFromMemory(assets.data(musicData), assets.dataSize(musicData)) && !simulation.gameOver) {
+                backgroundMusic.play();
             }
+            return reloaded;
         }
+        return assets.reload(file);
+    };
 
-        // Update and move first tumbleweed
-        elapsedTime += deltaTime;
-        if (elapsedTime >= frameSwitchTime) {
-            frameIndex = (frameIndex + 1) % 4;
-            tumbleweedSprite.setTextureRect(sf::IntRect(frameIndex * 100, 0, 100, 100));
-            tumbleweedSprite2.setTextureRect(sf::IntRect(frameIndex * 100, 0, 100, 100));
-            elapsedTime = 0.0f;
-        }
+    // The sim publishes a snapshot after each batch of ticks; the render thread
+    // draws the newest one, so a slow present never holds up the simulation
+    simulation.writeSnapshot(snapshots.writeBuffer(), camera.view());
+    snapshots.publish();
+    gameRenderer.store(&renderer, std::memory_order_release);
+    startup.mark("game-ready");
 
-        tumbleweedPosition.x += tumbleweedSpeed * deltaTime;
-        if (tumbleweedPosition.x < -100) {
-            tumbleweedPosition.x = 1920 + 100;  // Reset to just off the right side of the screen
-        }
-        tumbleweedSprite.setPosition(tumbleweedPosition);
+    const float tickTime = 1.0f / 60.0f;
+    float accumulator = 0.0f;
+    sf::Clock gameClock;
 
-        tumbleweedPosition2.x += tumbleweedSpeed2 * deltaTime;
-        if (tumbleweedPosition2.x > 1920 + 100) {
-            tumbleweedPosition2.x = -100;  // Reset to just off the left side of the screen
+    // Events must be handled on the thread that created the window
+    while (window.isOpen()) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) {
+                stopRendering();
+                window.close();
+            } else if (event.type == sf::Event::MouseButtonPressed) {
+                if (event.mouseButton.button == sf::Mouse::Left) {
+                    sf::Vector2f mousePos = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y), camera.view());
+                    SimVector position = toSimVector(mousePos);
+                    recorder.place(simulation.tickCount, position);
+                    simulation.placeTower(position);
+                }
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+                renderer.toggleMemoryOverlay();
+            } else if (event.type == sf::Event::MouseWheelScrolled) {
+                sf::Vector2f mousePos = window.mapPixelToCoords(sf::Vector2i(event.mouseWheelScroll.x, event.mouseWheelScroll.y), camera.view());
+                camera.zoomAt(event.mouseWheelScroll.delta > 0 ? 0.9f : 1.1f, mousePos);
+            }
         }
-        tumbleweedSprite2.setPosition(tumbleweedPosition2);
+        if (!window.isOpen()) break;
 
-        // Birds
-        birdAnimationTime += deltaTime;
-        if (birdAnimationTime >= birdFrameSwitchTime) {
-            birdFrameIndex = (birdFrameIndex + 1) % 2;
-            birdSprite.setTextureRect(sf::IntRect(birdFrameIndex * 135, 0, 135, 92));
-            birdSprite2.setTextureRect(sf::IntRect(birdFrameIndex * 135, 0, 135, 92));
-            birdAnimationTime = 0.0f;
+        std::vector<std::string> changed = watcher.changes();
+        if (!changed.empty()) {
+            std::lock_guard<std::mutex> lock(frameLock);
+            for (const auto& file : changed) {
+                if (reloadAsset(file)) LOG_INFO("Reloaded %s", file.c_str());
+            }
+            renderer.invalidateBackground();
+            renderer.invalidateText();
         }
 
-        birdPosition.x += birdSpeed * deltaTime;
-        if (birdPosition.x < -135) {
-            birdPosition.x = 1920;
+        // Deferred assets finish a couple per frame so uploads never cause a hitch
+        assets.poll(2);
+        if (textureBudget) {
+            std::lock_guard<std::mutex> lock(frameLock);
+            assets.trimTextures();
         }
-        birdSprite.setPosition(birdPosition);
-
-        birdPosition2.x += birdSpeed2 * deltaTime;
-        if (birdPosition2.x > 1920 + 135) {
-            birdPosition2.x = -135;
+        if (!musicStarted && assets.isLoaded(musicData)) {
+            musicStarted = true;
+            if (backgroundMusic.openFromMemory(assets.data(musicData), assets.dataSize(musicData)) && !simulation.gameOver) {
+                backgroundMusic.setLoop(true);  // Set the music to loop
+                backgroundMusic.play();         // Start playing the music
+                startup.mark("music");
+            }
         }
-        birdSprite2.setPosition(birdPosition2);
-
-        window.clear();
-        window.draw(mapSprite);
-
-        // Draw all static and dynamic game objects
-        for (const auto& object : staticObjects) {
-            window.draw(object);
+        if (!startup.has("font") && assets.isLoaded(gameFont)) startup.mark("font");
+        if (!startup.has("critters") && spriteAtlas.isReady(Atlas::frame(atlas::TumbleweedSheet, 0))) {
+            startup.mark("critters");
+        }
+        if ((reportStartup || exitAfterStartup) && !startupReported && startup.has("first-frame") &&
+            assets.pending(LoadPriority::Deferred) == 0) {
+            startup.mark("all-assets");
+            startupReported = true;
+            if (reportStartup) startup.report(stdout);
+            if (exitAfterStartup) {
+                stopRendering();
+                window.close();
+                break;
+            }
         }
 
-        if (!gameOver) {
-            window.draw(base.shape);
-            window.draw(base.healthBar);
-            for (auto& tower : towers) {
-                window.draw(tower.shape);
+        float frameTime = gameClock.restart().asSeconds();
+        camera.update(frameTime, window.hasFocus());
+
+        accumulator = std::min(accumulator + frameTime, 0.25f);  // Don't spiral after a stall
+        bool ticked = false;
+        while (accumulator >= tickTime) {
+            auto tickStart = std::chrono::steady_clock::now();
+            simulation.tick(tickTime);
+            metrics().record(TickTime, std::chrono::steady_clock::now() - tickStart);
+            // Hashed and logged every tick, unthrottled, so two sessions' debug logs
+            // can be compared tick by tick for a desync
+            TickHash hash;
+            simulation.hash(hash);
+            LOG_DEBUG_ALL("tick %lu hash %016llx %016llx %016llx %016llx", simulation.tickCount,
+                      static_cast<unsigned long long>(hash.subsystems[EnemiesHash]),
+                      static_cast<unsigned long long>(hash.subsystems[TowersHash]),
+                      static_cast<unsigned long long>(hash.subsystems[BaseHash]),
+                      static_cast<unsigned long long>(hash.subsystems[WavesHash]));
+            recorder.hash(simulation.tickCount, hash);
+            for (SoundEffect effect : simulation.soundEvents) {
+                sounds.play(effect);
             }
-            for (auto& enemy : enemies) {
-                if (!enemy.isDead) {
-                    window.draw(enemy.body);
-                    window.draw(enemy.healthBar);
-                }
-                window.draw(tumbleweedSprite);
-                window.draw(tumbleweedSprite2);
-                window.draw(birdSprite);
-                window.draw(birdSprite2);
+            accumulator -= tickTime;
+            ticked = true;
+        }
+
+        if (ticked) {
+            simulation.writeSnapshot(snapshots.writeBuffer(), camera.view());
+            snapshots.publish();
+            if (simulation.gameOver && backgroundMusic.getStatus() == sf::Music::Playing) {
+                backgroundMusic.stop();  // Optional: Stop music on game over
             }
-        } else {
-            window.draw(gameOverText);
         }
-        window.display();
+
+        sf::sleep(sf::seconds(tickTime - accumulator));
     }
-    
-    return 0;
+
+    return finish(0);
 }